@@ -0,0 +1,1006 @@
+#include "benchmark/tsv_mock_backend.hpp"
+#include "obs_plugin_texture_share_vk/tsv_receive_source.hpp"
+#include "obs_plugin_texture_share_vk/tsv_send_filter.hpp"
+#include "obs_plugin_texture_share_vk/tsv_send_scheduler.hpp"
+#include "obs_plugin_texture_share_vk/tsv_trace.hpp"
+
+#include <obs.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// Plugin sources are compiled without their module definitions. Provide locale lookup
+extern "C" const char *obs_module_text(const char *lookup_string)
+{
+	return lookup_string;
+}
+
+namespace
+{
+	constexpr uint64_t DEFAULT_FRAME_COUNT = 10000;
+	constexpr uint32_t FRAME_WIDTH         = 2560;
+	constexpr uint32_t FRAME_HEIGHT        = 1440;
+	constexpr float FRAME_SECONDS          = 1.0f / 60.0f;
+
+	// Linear colors, premultiplied alpha, flipped and swizzled
+	constexpr TsvConversion ALL_CONVERSIONS{true, true, true, true};
+
+	struct BenchmarkResult
+	{
+		uint64_t frames         = 0;
+		uint64_t total_ns       = 0;
+		uint64_t lock_hold_ns   = 0;
+		uint64_t lock_count     = 0;
+		uint64_t source_renders = 0;
+		TsvMockBackend::CallCounts calls;
+
+		// Send filters only: synchronization blocks left after the filters were destroyed
+		size_t sync_blocks = 0;
+
+		// Receive sources only
+		TsvStats::TimerSnapshot latency;
+		TsvStats::TimerSnapshot jitter;
+		uint64_t frames_dropped    = 0;
+		uint64_t frames_prefetched = 0;
+
+		// Time spent in the source's video_render, i.e. on the draw path
+		uint64_t render_ns = 0;
+	};
+
+	void PrintResult(const char *name, const BenchmarkResult &result)
+	{
+		const double frames     = static_cast<double>(result.frames);
+		const double latency_ms = result.latency.count > 0 ? result.latency.total_ns / 1e6 / result.latency.count : 0;
+		std::printf("%-36s %10.1f ns/frame %10.1f video_render ns/frame %10.1f lock ns/frame %6.2f locks/frame "
+		            "%6.2f source renders/frame %6.4f GPU allocations/frame %7.3f Mpx copied/frame "
+		            "%6.2f CPU frames/frame %6.2f ms latency %6.2f ms max jitter "
+		            "%6.2f client calls/frame (send %.2f, recv %.2f, find %.2f, find_data %.2f, init_image %.2f)\n",
+		            name, result.total_ns / frames, result.render_ns / frames, result.lock_hold_ns / frames,
+		            result.lock_count / frames,
+		            result.source_renders / frames, result.calls.gpu_allocations / frames,
+		            (result.calls.sent_pixels + result.calls.received_pixels + result.calls.copied_pixels) / frames /
+		                1e6,
+		            (result.calls.write_cpu_frame + result.calls.map_cpu_frame) / frames, latency_ms,
+		            result.jitter.max_ns / 1e6,
+		            result.calls.Total() / frames, result.calls.send_image / frames,
+		            result.calls.recv_image / frames, result.calls.find_image / frames,
+		            result.calls.find_image_data / frames, result.calls.init_image / frames);
+	}
+
+	obs_data_t *CreateSettings(const char *shared_texture_name)
+	{
+		obs_data_t *settings = obs_data_create();
+		obs_data_set_string(settings, TsvSendFilter::PROPERTY_SHARED_TEXTURE_NAME.data(), shared_texture_name);
+		return settings;
+	}
+
+	/*! \brief Send filter benchmark configuration
+	 */
+	struct SendFilterScenario
+	{
+		const char *name                         = "TsvSendFilter";
+		TsvSendFilter::CAPTURE_MODE capture_mode = TsvSendFilter::CAPTURE_FILTER_INPUT;
+		uint32_t buffer_count                    = TsvSendFilter::DEFAULT_BUFFER_COUNT;
+		uint32_t downscale_tiers                 = 0;
+		uint32_t send_rate                       = 0;
+		TsvPixelLayout::LAYOUT shared_layout     = TsvPixelLayout::RGBA;
+		bool lazy_send                           = false;
+		bool damage_tracking                     = false;
+		bool cpu_transport                       = false;
+		bool trace                               = false;
+
+		// Comma separated alias names
+		const char *aliases = "";
+
+		// Region of the source that changes every frame
+		TsvImageRect source_damage{0, 0, FRAME_WIDTH, FRAME_HEIGHT};
+
+		// Number of times the filter is rendered per video frame, e.g. when shown in multiple views
+		uint32_t renders_per_frame = 1;
+
+		// Number of filters, each on its own source and shared image. Sends are checked across all filters
+		uint32_t filter_count = 1;
+
+		// Whether all sends are expected to be made in the batched send pass, with at most one batch per frame
+		bool batched = false;
+
+		// Whether a consumer announces itself every frame
+		bool consumer = false;
+
+		// Number of polls before a GPU fence signals
+		uint32_t fence_latency = 0;
+
+		// Number of video frames until the client connected
+		uint64_t connect_latency = 0;
+
+		// Acceptable number of send_image calls
+		uint64_t min_sends = 0;
+		uint64_t max_sends = 0;
+
+		// Acceptable number of sent pixels. 0: Not checked
+		uint64_t max_sent_pixels = 0;
+
+		// Acceptable number of frames written to the CPU frame ring
+		uint64_t min_cpu_frames = 0;
+		uint64_t max_cpu_frames = 0;
+
+		// Settings switch to toggled_downscale_tiers and back every toggle_interval frames. 0: Settings don't change
+		uint64_t toggle_interval         = 0;
+		uint32_t toggled_downscale_tiers = 0;
+
+		// Acceptable number of init_image calls
+		uint64_t max_init_images = UINT64_MAX;
+
+		// Conversions applied while capturing
+		TsvConversion conversion;
+
+		// Acceptable number of render passes and draws, and number of passes expected to apply a conversion
+		uint64_t max_passes           = UINT64_MAX;
+		uint64_t min_converted_passes = 0;
+	};
+
+	void SetConversion(obs_data_t *settings, const TsvConversion &conversion)
+	{
+		obs_data_set_bool(settings, TsvConversion::PROPERTY_LINEAR_COLOR.data(), conversion.linear_color);
+		obs_data_set_bool(settings, TsvConversion::PROPERTY_PREMULTIPLY_ALPHA.data(), conversion.premultiply_alpha);
+		obs_data_set_bool(settings, TsvConversion::PROPERTY_FLIP_VERTICAL.data(), conversion.flip_vertical);
+		obs_data_set_bool(settings, TsvConversion::PROPERTY_SWIZZLE_BGRA.data(), conversion.swizzle_bgra);
+	}
+
+	void CheckPassCount(const char *name, uint64_t max_passes, uint64_t min_converted_passes,
+	                    const BenchmarkResult &result)
+	{
+		if(result.calls.passes > max_passes || result.calls.converted_passes < min_converted_passes)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu passes, %llu of them converted, got %llu and %llu\n", name,
+			             static_cast<unsigned long long>(max_passes),
+			             static_cast<unsigned long long>(min_converted_passes),
+			             static_cast<unsigned long long>(result.calls.passes),
+			             static_cast<unsigned long long>(result.calls.converted_passes));
+			std::exit(EXIT_FAILURE);
+		}
+	}
+
+	void CheckSendCount(const SendFilterScenario &scenario, const BenchmarkResult &result)
+	{
+		if(result.calls.send_image < scenario.min_sends || result.calls.send_image > scenario.max_sends)
+		{
+			std::fprintf(stderr, "%s: expected %llu-%llu sends, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.min_sends),
+			             static_cast<unsigned long long>(scenario.max_sends),
+			             static_cast<unsigned long long>(result.calls.send_image));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(scenario.max_sent_pixels > 0 && result.calls.sent_pixels > scenario.max_sent_pixels)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu sent pixels, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.max_sent_pixels),
+			             static_cast<unsigned long long>(result.calls.sent_pixels));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(scenario.batched &&
+		   (result.calls.batched_sends != result.calls.send_image || result.calls.send_batches > result.frames))
+		{
+			std::fprintf(stderr, "%s: expected all sends in at most one batch per frame, got %llu of %llu sends in "
+			             "%llu batches\n",
+			             scenario.name, static_cast<unsigned long long>(result.calls.batched_sends),
+			             static_cast<unsigned long long>(result.calls.send_image),
+			             static_cast<unsigned long long>(result.calls.send_batches));
+			std::exit(EXIT_FAILURE);
+		}
+
+		// Events of the most recent frames are in the module's trace
+		if(scenario.trace && TsvTrace::GetInstance().ToJson().find("\"name\":\"send_image\"") == std::string::npos)
+		{
+			std::fprintf(stderr, "%s: expected send_image trace events\n", scenario.name);
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(result.calls.write_cpu_frame < scenario.min_cpu_frames ||
+		   result.calls.write_cpu_frame > scenario.max_cpu_frames)
+		{
+			std::fprintf(stderr, "%s: expected %llu-%llu CPU frames, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.min_cpu_frames),
+			             static_cast<unsigned long long>(scenario.max_cpu_frames),
+			             static_cast<unsigned long long>(result.calls.write_cpu_frame));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(result.calls.init_image > scenario.max_init_images)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu init_image calls, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.max_init_images),
+			             static_cast<unsigned long long>(result.calls.init_image));
+			std::exit(EXIT_FAILURE);
+		}
+
+		// Destroyed filters remove all synchronization blocks, consumers don't recreate them
+		if(result.sync_blocks > 0)
+		{
+			std::fprintf(stderr, "%s: expected no synchronization blocks after destroying the filters, got %zu\n",
+			             scenario.name, result.sync_blocks);
+			std::exit(EXIT_FAILURE);
+		}
+
+		// The filter input is passed on without losing precision to conversions
+		if(result.calls.lossy_passes > 0)
+		{
+			std::fprintf(stderr, "%s: expected no lossy passes, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(result.calls.lossy_passes));
+			std::exit(EXIT_FAILURE);
+		}
+
+		CheckPassCount(scenario.name, scenario.max_passes, scenario.min_converted_passes, result);
+	}
+
+	BenchmarkResult BenchmarkSendFilter(uint64_t frame_count, const SendFilterScenario &scenario)
+	{
+		struct BenchFilter
+		{
+			std::string name;
+			TsvMockBackend *mock = nullptr;
+			obs_data_t *settings = nullptr;
+			std::unique_ptr<TsvSendFilter> filter;
+		};
+
+		std::vector<BenchFilter> filters(scenario.filter_count);
+		for(uint32_t i = 0; i < scenario.filter_count; ++i)
+		{
+			BenchFilter &bench_filter = filters[i];
+			bench_filter.name         = i == 0 ? "bench_send" : "bench_send_" + std::to_string(i);
+
+			auto backend               = std::make_unique<TsvMockBackend>();
+			TsvMockBackend &mock       = *backend;
+			obs_data_t *const settings = CreateSettings(bench_filter.name.c_str());
+			obs_data_set_bool(settings, TsvSendFilter::PROPERTY_LAZY_SEND.data(), scenario.lazy_send);
+			obs_data_set_int(settings, TsvSendFilter::PROPERTY_CAPTURE_MODE.data(), scenario.capture_mode);
+			obs_data_set_int(settings, TsvSendFilter::PROPERTY_BUFFER_COUNT.data(), scenario.buffer_count);
+			obs_data_set_int(settings, TsvSendFilter::PROPERTY_DOWNSCALE_TIERS.data(), scenario.downscale_tiers);
+			obs_data_set_int(settings, TsvSendFilter::PROPERTY_SEND_RATE.data(), scenario.send_rate);
+			obs_data_set_int(settings, TsvSendFilter::PROPERTY_SHARED_FORMAT.data(), scenario.shared_layout);
+			obs_data_set_bool(settings, TsvSendFilter::PROPERTY_DAMAGE_TRACKING.data(), scenario.damage_tracking);
+			obs_data_set_bool(settings, TsvSendFilter::PROPERTY_CPU_TRANSPORT.data(), scenario.cpu_transport);
+			obs_data_set_bool(settings, TsvTrace::PROPERTY_TRACE.data(), scenario.trace);
+			obs_data_set_string(settings, TsvSendFilter::PROPERTY_SHARED_TEXTURE_ALIASES.data(), scenario.aliases);
+			SetConversion(settings, scenario.conversion);
+
+			mock.SetSourceSize(FRAME_WIDTH, FRAME_HEIGHT);
+			mock.SetSourceDamage(scenario.source_damage);
+			mock.SetFenceLatency(scenario.fence_latency);
+			mock.SetConnectLatency(scenario.connect_latency);
+
+			bench_filter.mock     = &mock;
+			bench_filter.settings = settings;
+			bench_filter.filter   = std::make_unique<TsvSendFilter>(settings, nullptr, std::move(backend));
+		}
+
+		// obs_source_video_render() calls the filter's video_render
+		uint64_t source_renders = 0;
+		for(BenchFilter &bench_filter : filters)
+		{
+			TsvSendFilter &filter = *bench_filter.filter;
+			bench_filter.mock->SetRenderSourceCallback([&filter, &source_renders]() {
+				++source_renders;
+				filter.Render(nullptr);
+			});
+		}
+
+		// Receive source in another process
+		TsvMockBackend consumer;
+
+		// OBS runs the scheduler's main render callback once per video frame
+		TsvSendScheduler &scheduler = TsvSendScheduler::GetInstance();
+		const auto render_frame     = [&filters, &scenario, &scheduler, &consumer]() {
+			for(BenchFilter &bench_filter : filters)
+			{
+				if(scenario.consumer)
+					consumer.AnnounceConsumer(bench_filter.name.c_str());
+
+				bench_filter.mock->AdvanceVideoFrame();
+			}
+
+			for(BenchFilter &bench_filter : filters)
+			{
+				for(uint32_t render = 0; render < scenario.renders_per_frame; ++render)
+					bench_filter.filter->Render(nullptr);
+			}
+
+			scheduler.SendPass(FRAME_WIDTH, FRAME_HEIGHT);
+		};
+
+		// Warm up: create render targets and shared images
+		render_frame();
+		uint64_t lock_hold_start  = 0;
+		uint64_t lock_count_start = 0;
+		for(BenchFilter &bench_filter : filters)
+		{
+			bench_filter.mock->ResetCallCounts();
+			lock_hold_start += bench_filter.filter->GetAccessMutex().HoldTimeNs();
+			lock_count_start += bench_filter.filter->GetAccessMutex().LockCount();
+		}
+
+		source_renders = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		for(uint64_t i = 0; i < frame_count; ++i)
+		{
+			// Settings changed in the UI thread are picked up with the next frame
+			if(scenario.toggle_interval > 0 && i % scenario.toggle_interval == 0)
+			{
+				const bool toggled = (i / scenario.toggle_interval) % 2 == 0;
+				for(BenchFilter &bench_filter : filters)
+				{
+					obs_data_set_int(bench_filter.settings, TsvSendFilter::PROPERTY_DOWNSCALE_TIERS.data(),
+					                 toggled ? scenario.toggled_downscale_tiers : scenario.downscale_tiers);
+					bench_filter.filter->UpdateProperties(bench_filter.settings);
+				}
+			}
+
+			render_frame();
+		}
+
+		const auto end = std::chrono::steady_clock::now();
+
+		BenchmarkResult result;
+		result.frames         = frame_count;
+		result.total_ns       = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		result.source_renders = source_renders;
+		for(BenchFilter &bench_filter : filters)
+		{
+			result.lock_hold_ns += bench_filter.filter->GetAccessMutex().HoldTimeNs();
+			result.lock_count += bench_filter.filter->GetAccessMutex().LockCount();
+			result.calls += bench_filter.mock->GetCallCounts();
+		}
+
+		result.lock_hold_ns -= lock_hold_start;
+		result.lock_count -= lock_count_start;
+
+		for(BenchFilter &bench_filter : filters)
+			obs_data_release(bench_filter.settings);
+
+		// Consumers that are still drawn keep announcing themselves once the filters are gone
+		std::vector<std::string> names;
+		for(const BenchFilter &bench_filter : filters)
+			names.push_back(bench_filter.name);
+
+		filters.clear();
+		for(const std::string &name : names)
+			consumer.AnnounceConsumer(name.c_str());
+
+		result.sync_blocks = TsvMockBackend::GetSyncBlockCount();
+
+		return result;
+	}
+
+	/*! \brief Receive source benchmark configuration
+	 */
+	struct ReceiveSourceScenario
+	{
+		const char *name = "TsvReceiveSource";
+
+		// Sender publishes a new frame generation every publish_interval frames. 0: Sender doesn't publish
+		// generations
+		uint64_t publish_interval = 0;
+
+		// Sender switches between two resolutions every resize_interval frames. 0: Sender doesn't resize
+		uint64_t resize_interval = 0;
+
+		// Pixel layout the sender packs the image into. Not combined with resize_interval
+		TsvPixelLayout::LAYOUT layout = TsvPixelLayout::RGBA;
+
+		// Region the sender reports as changed with each published frame
+		TsvImageRect damage{0, 0, FRAME_WIDTH, FRAME_HEIGHT};
+
+		// With TRANSPORT_SHARED_MEMORY, the sender writes CPU frames instead of publishing frame generations
+		TsvReceiveSource::TRANSPORT transport = TsvReceiveSource::TRANSPORT_GPU;
+
+		// Published frames arrive up to arrival_jitter video frames after they were captured, alternating between no
+		// and maximum delay. Less than publish_interval
+		uint64_t arrival_jitter = 0;
+
+		// Jitter buffer size of the receive source (in video frames)
+		uint32_t jitter_buffer = 0;
+
+		// Run the source's main render callback before drawing, as OBS does
+		bool prefetch = false;
+
+		// Pixels cropped from each edge of the image
+		uint32_t crop_left   = 0;
+		uint32_t crop_top    = 0;
+		uint32_t crop_right  = 0;
+		uint32_t crop_bottom = 0;
+
+		// Number of views the source is drawn in per frame
+		uint32_t renders_per_frame = 1;
+
+		// Source is ticked but not drawn after warming up, e.g. as part of an unused scene
+		bool hidden = false;
+
+		// Acceptable number of consumer heartbeats
+		uint64_t max_announcements = UINT64_MAX;
+
+		// Acceptable number of recv_image calls, or of mapped CPU frames
+		uint64_t min_recvs = 0;
+		uint64_t max_recvs = 0;
+
+		// Acceptable number of received pixels. 0: Not checked
+		uint64_t max_received_pixels = 0;
+
+		// Acceptable number of pixels copied between textures, in addition to the received ones
+		uint64_t max_copied_pixels = UINT64_MAX;
+
+		// Acceptable number of texture allocations
+		uint64_t max_allocations = 0;
+
+		// Acceptable maximum jitter (in ns) and number of dropped frames
+		uint64_t max_jitter_ns = UINT64_MAX;
+		uint64_t max_dropped   = UINT64_MAX;
+
+		// Whether the source is expected to draw a frame every time it is rendered, e.g. while the image is resized
+		bool draw_every_render = false;
+
+		// Conversions the sender applied
+		TsvConversion conversion;
+
+		// Acceptable number of render passes and draws, and number of passes expected to apply a conversion
+		uint64_t max_passes           = UINT64_MAX;
+		uint64_t min_converted_passes = 0;
+	};
+
+	void CheckRecvCount(const ReceiveSourceScenario &scenario, const BenchmarkResult &result)
+	{
+		const uint64_t recvs = scenario.transport == TsvReceiveSource::TRANSPORT_SHARED_MEMORY
+		                           ? result.calls.map_cpu_frame
+		                           : result.calls.recv_image;
+		if(recvs < scenario.min_recvs || recvs > scenario.max_recvs)
+		{
+			std::fprintf(stderr, "%s: expected %llu-%llu receives, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.min_recvs),
+			             static_cast<unsigned long long>(scenario.max_recvs), static_cast<unsigned long long>(recvs));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(result.calls.gpu_allocations > scenario.max_allocations)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu GPU allocations, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.max_allocations),
+			             static_cast<unsigned long long>(result.calls.gpu_allocations));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(scenario.max_received_pixels > 0 && result.calls.received_pixels > scenario.max_received_pixels)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu received pixels, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.max_received_pixels),
+			             static_cast<unsigned long long>(result.calls.received_pixels));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(result.calls.copied_pixels > scenario.max_copied_pixels)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu pixels copied between textures, got %llu\n",
+			             scenario.name, static_cast<unsigned long long>(scenario.max_copied_pixels),
+			             static_cast<unsigned long long>(result.calls.copied_pixels));
+			std::exit(EXIT_FAILURE);
+		}
+
+		// All copies should happen ahead of video_render, except for the first frame
+		if(scenario.prefetch && result.frames_prefetched + 1 < recvs)
+		{
+			std::fprintf(stderr, "%s: expected %llu prefetched frames, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(recvs),
+			             static_cast<unsigned long long>(result.frames_prefetched));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(result.jitter.max_ns > scenario.max_jitter_ns || result.frames_dropped > scenario.max_dropped)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu ns jitter and %llu dropped frames, got %llu and %llu\n",
+			             scenario.name, static_cast<unsigned long long>(scenario.max_jitter_ns),
+			             static_cast<unsigned long long>(scenario.max_dropped),
+			             static_cast<unsigned long long>(result.jitter.max_ns),
+			             static_cast<unsigned long long>(result.frames_dropped));
+			std::exit(EXIT_FAILURE);
+		}
+
+		const uint64_t renders = result.frames * scenario.renders_per_frame;
+		if(scenario.draw_every_render && result.calls.draws != renders)
+		{
+			std::fprintf(stderr, "%s: expected %llu draws, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(renders), static_cast<unsigned long long>(result.calls.draws));
+			std::exit(EXIT_FAILURE);
+		}
+
+		if(result.calls.consumer_announcements > scenario.max_announcements)
+		{
+			std::fprintf(stderr, "%s: expected at most %llu consumer announcements, got %llu\n", scenario.name,
+			             static_cast<unsigned long long>(scenario.max_announcements),
+			             static_cast<unsigned long long>(result.calls.consumer_announcements));
+			std::exit(EXIT_FAILURE);
+		}
+
+		CheckPassCount(scenario.name, scenario.max_passes, scenario.min_converted_passes, result);
+	}
+
+	BenchmarkResult BenchmarkReceiveSource(uint64_t frame_count, const ReceiveSourceScenario &scenario)
+	{
+		auto backend               = std::make_unique<TsvMockBackend>();
+		TsvMockBackend &mock       = *backend;
+		obs_data_t *const settings = CreateSettings("bench_recv");
+		obs_data_set_int(settings, TsvReceiveSource::PROPERTY_TRANSPORT.data(), scenario.transport);
+		obs_data_set_int(settings, TsvReceiveSource::PROPERTY_JITTER_BUFFER.data(), scenario.jitter_buffer);
+		obs_data_set_int(settings, TsvReceiveSource::PROPERTY_CROP_LEFT.data(), scenario.crop_left);
+		obs_data_set_int(settings, TsvReceiveSource::PROPERTY_CROP_TOP.data(), scenario.crop_top);
+		obs_data_set_int(settings, TsvReceiveSource::PROPERTY_CROP_RIGHT.data(), scenario.crop_right);
+		obs_data_set_int(settings, TsvReceiveSource::PROPERTY_CROP_BOTTOM.data(), scenario.crop_bottom);
+		SetConversion(settings, scenario.conversion);
+
+		const bool cpu_frames = scenario.transport == TsvReceiveSource::TRANSPORT_SHARED_MEMORY;
+		if(cpu_frames)
+			mock.WriteCpuFrame("bench_recv", nullptr, FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH * 4, GS_RGBA);
+
+		uint32_t packed_width, packed_height;
+		TsvPixelLayout::GetPackedSize(scenario.layout, FRAME_WIDTH, FRAME_HEIGHT, packed_width, packed_height);
+		mock.PublishImage("bench_recv", packed_width, packed_height, ImgFormat::R8G8B8A8);
+		if(scenario.layout != TsvPixelLayout::RGBA)
+			mock.PublishImageInfo("bench_recv", FRAME_WIDTH, FRAME_HEIGHT, ImgFormat::R8G8B8A8, scenario.layout);
+
+		TsvReceiveSource source(settings, nullptr, std::move(backend));
+		obs_data_release(settings);
+
+		// Warm up: the image watcher reported the shared image, first render looks it up. Packed images report their
+		// unpacked size, cropped images their cropped size
+		source.Render(nullptr);
+		if(source.GetWidth() != FRAME_WIDTH - scenario.crop_left - scenario.crop_right ||
+		   source.GetHeight() != FRAME_HEIGHT - scenario.crop_top - scenario.crop_bottom)
+		{
+			std::fprintf(stderr, "Receive source: shared image not found\n");
+			std::exit(EXIT_FAILURE);
+		}
+
+		mock.ResetCallCounts();
+
+		const uint64_t lock_hold_start  = source.GetAccessMutex().HoldTimeNs();
+		const uint64_t lock_count_start = source.GetAccessMutex().LockCount();
+
+		// Capture time of the frame the sender publishes next
+		uint64_t capture_ns = 0;
+
+		uint64_t render_ns = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		for(uint64_t i = 0; i < frame_count; ++i)
+		{
+			mock.AdvanceVideoFrame();
+
+			if(scenario.resize_interval > 0 && i % scenario.resize_interval == 0)
+			{
+				const bool small = (i / scenario.resize_interval) % 2 == 0;
+				mock.PublishImage("bench_recv", small ? FRAME_WIDTH / 2 : FRAME_WIDTH,
+				                  small ? FRAME_HEIGHT / 2 : FRAME_HEIGHT, ImgFormat::R8G8B8A8);
+			}
+
+			// Frame k is captured in video frame k * publish_interval, and every other frame arrives late
+			const uint64_t arrival_delay =
+				scenario.publish_interval > 0 && (i / scenario.publish_interval) % 2 == 1 ? scenario.arrival_jitter : 0;
+			if(scenario.publish_interval > 0 && i % scenario.publish_interval == 0)
+				capture_ns = mock.GetVideoFrameTime();
+
+			if(scenario.publish_interval > 0 && i >= arrival_delay &&
+			   (i - arrival_delay) % scenario.publish_interval == 0)
+			{
+				if(cpu_frames)
+					mock.WriteCpuFrame("bench_recv", nullptr, FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH * 4, GS_RGBA);
+				else
+					mock.PublishFrame("bench_recv", scenario.damage, capture_ns);
+			}
+
+			source.OnTick(FRAME_SECONDS);
+			if(scenario.prefetch)
+				source.Prefetch(FRAME_WIDTH, FRAME_HEIGHT);
+
+			const auto render_start = std::chrono::steady_clock::now();
+			for(uint32_t render = 0; !scenario.hidden && render < scenario.renders_per_frame; ++render)
+				source.Render(nullptr);
+
+			render_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+			                                                                  render_start)
+			                 .count();
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		BenchmarkResult result;
+		result.frames       = frame_count;
+		result.total_ns     = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		result.lock_hold_ns = source.GetAccessMutex().HoldTimeNs() - lock_hold_start;
+		result.lock_count   = source.GetAccessMutex().LockCount() - lock_count_start;
+		result.calls        = mock.GetCallCounts();
+
+		result.latency        = source.GetStats().GetTimer(TsvStats::LATENCY);
+		result.jitter         = source.GetStats().GetTimer(TsvStats::JITTER);
+		result.frames_dropped = source.GetStats().GetCount(TsvStats::FRAMES_DROPPED);
+
+		result.frames_prefetched = source.GetStats().GetCount(TsvStats::FRAMES_PREFETCHED);
+		result.render_ns         = render_ns;
+
+		// The emulated sender stops, so the next scenario starts without its synchronization block
+		mock.RevokeImageInfo("bench_recv");
+
+		return result;
+	}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	uint64_t frame_count = DEFAULT_FRAME_COUNT;
+	if(argc > 1)
+		frame_count = std::strtoull(argv[1], nullptr, 10);
+
+	if(frame_count == 0)
+	{
+		std::fprintf(stderr, "Usage: %s [frame_count]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::printf("Frames: %llu, size: %ux%u\n", static_cast<unsigned long long>(frame_count), FRAME_WIDTH,
+	            FRAME_HEIGHT);
+
+	std::vector<SendFilterScenario> send_scenarios(27);
+
+	send_scenarios[0].min_sends = frame_count;
+	send_scenarios[0].max_sends = frame_count;
+
+	send_scenarios[1].name         = "TsvSendFilter (offscreen)";
+	send_scenarios[1].capture_mode = TsvSendFilter::CAPTURE_OFFSCREEN_RENDER;
+	send_scenarios[1].min_sends    = frame_count;
+	send_scenarios[1].max_sends    = frame_count;
+
+	send_scenarios[2].name         = "TsvSendFilter (unbuffered)";
+	send_scenarios[2].buffer_count = 1;
+	send_scenarios[2].min_sends    = frame_count;
+	send_scenarios[2].max_sends    = frame_count;
+
+	// Fences signal one frame late. Frames are published later, but none are dropped
+	send_scenarios[3].name          = "TsvSendFilter (GPU latency)";
+	send_scenarios[3].fence_latency = 1;
+	send_scenarios[3].min_sends     = frame_count - TsvSendFilter::DEFAULT_BUFFER_COUNT;
+	send_scenarios[3].max_sends     = frame_count;
+
+	send_scenarios[4].name      = "TsvSendFilter (lazy, idle)";
+	send_scenarios[4].lazy_send = true;
+
+	send_scenarios[5].name      = "TsvSendFilter (lazy)";
+	send_scenarios[5].lazy_send = true;
+	send_scenarios[5].consumer  = true;
+	send_scenarios[5].min_sends = frame_count;
+	send_scenarios[5].max_sends = frame_count;
+
+	// Full, half and quarter resolution from a single render
+	send_scenarios[6].name            = "TsvSendFilter (downscale tiers)";
+	send_scenarios[6].buffer_count    = 1;
+	send_scenarios[6].downscale_tiers = 2;
+	send_scenarios[6].min_sends       = 3 * frame_count;
+	send_scenarios[6].max_sends       = 3 * frame_count;
+
+	// Only the full resolution image is read, tiers are neither downscaled nor sent
+	send_scenarios[7].name            = "TsvSendFilter (lazy, tiers)";
+	send_scenarios[7].buffer_count    = 1;
+	send_scenarios[7].downscale_tiers = 2;
+	send_scenarios[7].lazy_send       = true;
+	send_scenarios[7].consumer        = true;
+	send_scenarios[7].min_sends       = frame_count;
+	send_scenarios[7].max_sends       = frame_count;
+
+	// 15 fps out of 60 fps: Every 4th frame is captured and sent, the others are passed through
+	send_scenarios[8].name      = "TsvSendFilter (15 fps)";
+	send_scenarios[8].send_rate = 15;
+	send_scenarios[8].min_sends = frame_count / 4 - TsvSendFilter::DEFAULT_BUFFER_COUNT;
+	send_scenarios[8].max_sends = frame_count / 4 + 1;
+
+	// Filter rendered in two views. Each frame is only captured and sent once. The second view already publishes
+	// the frame captured by the first one
+	send_scenarios[9].name              = "TsvSendFilter (two views)";
+	send_scenarios[9].renders_per_frame = 2;
+	send_scenarios[9].min_sends         = frame_count;
+	send_scenarios[9].max_sends         = frame_count + 1;
+
+	// Packed into an RGBA image of 3/8 the size before sending
+	send_scenarios[10].name          = "TsvSendFilter (NV12)";
+	send_scenarios[10].shared_layout = TsvPixelLayout::NV12;
+	send_scenarios[10].min_sends     = frame_count;
+	send_scenarios[10].max_sends     = frame_count;
+
+	send_scenarios[11].name          = "TsvSendFilter (R10G10B10A2)";
+	send_scenarios[11].shared_layout = TsvPixelLayout::R10G10B10A2;
+	send_scenarios[11].min_sends     = frame_count;
+	send_scenarios[11].max_sends     = frame_count;
+
+	// Static source. Only the first frame is sent, the others are compared and dropped. The send pass already sends
+	// the first frame while warming up
+	send_scenarios[12].name            = "TsvSendFilter (static, damage)";
+	send_scenarios[12].damage_tracking = true;
+	send_scenarios[12].source_damage   = TsvImageRect{};
+	send_scenarios[12].min_sends       = 0;
+	send_scenarios[12].max_sends       = 0;
+
+	// Only a tile aligned 256x128 region changes. Apart from the first frame, only that region is sent
+	send_scenarios[13].name            = "TsvSendFilter (partial, damage)";
+	send_scenarios[13].damage_tracking = true;
+	send_scenarios[13].source_damage   = TsvImageRect{64, 64, 256, 128};
+	send_scenarios[13].min_sends       = frame_count;
+	send_scenarios[13].max_sends       = frame_count;
+	send_scenarios[13].max_sent_pixels = FRAME_WIDTH * FRAME_HEIGHT + (frame_count - 1) * 256 * 128;
+
+	// Every frame is additionally read back and written to the CPU frame ring
+	send_scenarios[14].name           = "TsvSendFilter (CPU transport)";
+	send_scenarios[14].cpu_transport  = true;
+	send_scenarios[14].min_sends      = frame_count;
+	send_scenarios[14].max_sends      = frame_count;
+	send_scenarios[14].min_cpu_frames = frame_count;
+	send_scenarios[14].max_cpu_frames = frame_count;
+
+	// Static source. The CPU frame ring already holds the first frame, written while warming up. Later ones are not
+	// written
+	send_scenarios[15].name            = "TsvSendFilter (static, CPU)";
+	send_scenarios[15].cpu_transport   = true;
+	send_scenarios[15].damage_tracking = true;
+	send_scenarios[15].source_damage   = TsvImageRect{};
+	send_scenarios[15].min_sends       = 0;
+	send_scenarios[15].max_sends       = 0;
+	send_scenarios[15].min_cpu_frames  = 0;
+	send_scenarios[15].max_cpu_frames  = 0;
+
+	// Source rendered once per frame and sent to the shared image and two aliases. Duplicate names are dropped
+	send_scenarios[16].name         = "TsvSendFilter (aliases)";
+	send_scenarios[16].capture_mode = TsvSendFilter::CAPTURE_OFFSCREEN_RENDER;
+	send_scenarios[16].aliases      = "bench_alias_a, bench_alias_b,,bench_alias_a,bench_send";
+	send_scenarios[16].min_sends    = 3 * frame_count;
+	send_scenarios[16].max_sends    = 3 * frame_count;
+
+	// Static source. Each name only receives the first frame, which is sent while warming up
+	send_scenarios[17].name            = "TsvSendFilter (static, aliases)";
+	send_scenarios[17].aliases         = "bench_alias_a,bench_alias_b";
+	send_scenarios[17].damage_tracking = true;
+	send_scenarios[17].source_damage   = TsvImageRect{};
+	send_scenarios[17].min_sends       = 0;
+	send_scenarios[17].max_sends       = 0;
+
+	// Many filters, e.g. one per scene. All frames are sent in one batch per video frame
+	send_scenarios[18].name         = "TsvSendFilter (20 filters)";
+	send_scenarios[18].filter_count = 20;
+	send_scenarios[18].batched      = true;
+	send_scenarios[18].min_sends    = 20 * frame_count;
+	send_scenarios[18].max_sends    = 20 * frame_count;
+
+	send_scenarios[19].name         = "TsvSendFilter (20 filters, offscreen)";
+	send_scenarios[19].capture_mode = TsvSendFilter::CAPTURE_OFFSCREEN_RENDER;
+	send_scenarios[19].filter_count = 20;
+	send_scenarios[19].batched      = true;
+	send_scenarios[19].min_sends    = 20 * frame_count;
+	send_scenarios[19].max_sends    = 20 * frame_count;
+
+	// Render, OffscreenRender and send_image are recorded as trace events
+	send_scenarios[20].name      = "TsvSendFilter (trace)";
+	send_scenarios[20].trace     = true;
+	send_scenarios[20].min_sends = frame_count;
+	send_scenarios[20].max_sends = frame_count;
+
+	// A second tier is added and removed every 60 frames. Only that tier's image is initialized again, the shared
+	// image and the first tier keep theirs
+	send_scenarios[21].name                    = "TsvSendFilter (tier toggle)";
+	send_scenarios[21].buffer_count            = 1;
+	send_scenarios[21].downscale_tiers         = 1;
+	send_scenarios[21].toggle_interval         = 60;
+	send_scenarios[21].toggled_downscale_tiers = 2;
+	send_scenarios[21].min_sends               = 2 * frame_count;
+	send_scenarios[21].max_sends               = 3 * frame_count;
+	send_scenarios[21].max_init_images         = frame_count / 120 + 1;
+
+	// Server takes half a second to launch. The filter passes its input through until then and sends afterwards. The
+	// client connects in video frame 30, video frames 2 to frame_count + 1 are measured
+	send_scenarios[22].name            = "TsvSendFilter (connecting)";
+	send_scenarios[22].connect_latency = 30;
+	send_scenarios[22].min_sends       = frame_count - 28 - TsvSendFilter::DEFAULT_BUFFER_COUNT;
+	send_scenarios[22].max_sends       = frame_count - 28;
+
+	// Every conversion is applied while capturing and undone while passing the input on. Still one capture and one
+	// draw per frame
+	send_scenarios[23].name                 = "TsvSendFilter (conversions)";
+	send_scenarios[23].conversion           = ALL_CONVERSIONS;
+	send_scenarios[23].min_sends            = frame_count;
+	send_scenarios[23].max_sends            = frame_count;
+	send_scenarios[23].max_passes           = 2 * frame_count;
+	send_scenarios[23].min_converted_passes = 2 * frame_count;
+
+	// Flipped and premultiplied while the source renders into the render target, no further pass
+	send_scenarios[24].name                         = "TsvSendFilter (offscreen, conversions)";
+	send_scenarios[24].capture_mode                 = TsvSendFilter::CAPTURE_OFFSCREEN_RENDER;
+	send_scenarios[24].conversion.flip_vertical     = true;
+	send_scenarios[24].conversion.premultiply_alpha = true;
+	send_scenarios[24].min_sends                    = frame_count;
+	send_scenarios[24].max_sends                    = frame_count;
+	send_scenarios[24].max_passes                   = frame_count;
+	send_scenarios[24].min_converted_passes         = frame_count;
+
+	// Send rates that don't divide 60 fps: 3 of 4 frames, and 2 of 5 frames are sent
+	send_scenarios[25].name      = "TsvSendFilter (45 fps)";
+	send_scenarios[25].send_rate = 45;
+	send_scenarios[25].min_sends = frame_count * 3 / 4 - TsvSendFilter::DEFAULT_BUFFER_COUNT;
+	send_scenarios[25].max_sends = frame_count * 3 / 4 + 1;
+
+	send_scenarios[26].name      = "TsvSendFilter (24 fps)";
+	send_scenarios[26].send_rate = 24;
+	send_scenarios[26].min_sends = frame_count * 2 / 5 - TsvSendFilter::DEFAULT_BUFFER_COUNT;
+	send_scenarios[26].max_sends = frame_count * 2 / 5 + 1;
+
+	for(const SendFilterScenario &scenario : send_scenarios)
+	{
+		const BenchmarkResult result = BenchmarkSendFilter(frame_count, scenario);
+		CheckSendCount(scenario, result);
+		PrintResult(scenario.name, result);
+	}
+
+	std::vector<ReceiveSourceScenario> receive_scenarios(18);
+
+	receive_scenarios[0].min_recvs = frame_count;
+	receive_scenarios[0].max_recvs = frame_count;
+
+	receive_scenarios[1].name             = "TsvReceiveSource (same rate)";
+	receive_scenarios[1].publish_interval = 1;
+	receive_scenarios[1].min_recvs        = frame_count;
+	receive_scenarios[1].max_recvs        = frame_count;
+
+	receive_scenarios[2].name             = "TsvReceiveSource (half rate)";
+	receive_scenarios[2].publish_interval = 2;
+	receive_scenarios[2].min_recvs        = frame_count / 2;
+	receive_scenarios[2].max_recvs        = frame_count / 2 + 1;
+
+	// Sender published a single frame
+	receive_scenarios[3].name             = "TsvReceiveSource (static)";
+	receive_scenarios[3].publish_interval = frame_count;
+	receive_scenarios[3].min_recvs        = 1;
+	receive_scenarios[3].max_recvs        = 1;
+
+	// Sender toggles between two resolutions. Only the first switch allocates, later ones reuse pooled textures
+	receive_scenarios[4].name             = "TsvReceiveSource (resize)";
+	receive_scenarios[4].publish_interval = 1;
+	receive_scenarios[4].resize_interval  = 60;
+	receive_scenarios[4].min_recvs        = frame_count;
+	receive_scenarios[4].max_recvs        = frame_count;
+	receive_scenarios[4].max_allocations  = 1;
+
+	receive_scenarios[5].name             = "TsvReceiveSource (NV12)";
+	receive_scenarios[5].publish_interval = 1;
+	receive_scenarios[5].layout           = TsvPixelLayout::NV12;
+	receive_scenarios[5].min_recvs        = frame_count;
+	receive_scenarios[5].max_recvs        = frame_count;
+
+	// Sender only changes a 256x128 region. Apart from the first frame, only that region is copied
+	receive_scenarios[6].name                = "TsvReceiveSource (partial)";
+	receive_scenarios[6].publish_interval    = 1;
+	receive_scenarios[6].damage              = TsvImageRect{64, 64, 256, 128};
+	receive_scenarios[6].min_recvs           = frame_count;
+	receive_scenarios[6].max_recvs           = frame_count;
+	receive_scenarios[6].max_received_pixels = FRAME_WIDTH * FRAME_HEIGHT + (frame_count - 1) * 256 * 128;
+
+	// Sender writes CPU frames at half rate. Each is uploaded once into the texture created on the first frame
+	receive_scenarios[7].name             = "TsvReceiveSource (shared memory)";
+	receive_scenarios[7].transport        = TsvReceiveSource::TRANSPORT_SHARED_MEMORY;
+	receive_scenarios[7].publish_interval = 2;
+	receive_scenarios[7].min_recvs        = frame_count / 2;
+	receive_scenarios[7].max_recvs        = frame_count / 2 + 1;
+
+	// Sender at half rate, every other frame arrives one video frame late. Drawn right away, frames alternately show
+	// for one and three video frames
+	receive_scenarios[8].name             = "TsvReceiveSource (arrival jitter)";
+	receive_scenarios[8].publish_interval = 2;
+	receive_scenarios[8].arrival_jitter   = 1;
+	receive_scenarios[8].min_recvs        = frame_count / 2 - 1;
+	receive_scenarios[8].max_recvs        = frame_count / 2 + 1;
+	receive_scenarios[8].max_dropped      = 0;
+
+	// Same arrival pattern, held back by two video frames. Every frame shows for two video frames at equal latency.
+	// Frames are received straight into the jitter buffer
+	receive_scenarios[9].name              = "TsvReceiveSource (jitter buffer)";
+	receive_scenarios[9].publish_interval  = 2;
+	receive_scenarios[9].arrival_jitter    = 1;
+	receive_scenarios[9].jitter_buffer     = 2;
+	receive_scenarios[9].min_recvs         = frame_count / 2 - 1;
+	receive_scenarios[9].max_recvs         = frame_count / 2 + 1;
+	receive_scenarios[9].max_allocations   = 4;
+	receive_scenarios[9].max_jitter_ns     = 0;
+	receive_scenarios[9].max_dropped       = 0;
+	receive_scenarios[9].max_copied_pixels = 0;
+
+	// Frames are copied by the main render callback, video_render only draws
+	receive_scenarios[10].name             = "TsvReceiveSource (prefetch)";
+	receive_scenarios[10].publish_interval = 1;
+	receive_scenarios[10].prefetch         = true;
+	receive_scenarios[10].min_recvs        = frame_count;
+	receive_scenarios[10].max_recvs        = frame_count;
+
+	// Drawn in preview and program. Each frame is still copied once
+	receive_scenarios[11].name              = "TsvReceiveSource (prefetch, 2 views)";
+	receive_scenarios[11].publish_interval  = 1;
+	receive_scenarios[11].prefetch          = true;
+	receive_scenarios[11].renders_per_frame = 2;
+	receive_scenarios[11].min_recvs         = frame_count;
+	receive_scenarios[11].max_recvs         = frame_count;
+
+	// Only a 512x720 part in the middle of the image is shown
+	receive_scenarios[12].name                = "TsvReceiveSource (crop)";
+	receive_scenarios[12].publish_interval    = 1;
+	receive_scenarios[12].crop_left           = 1024;
+	receive_scenarios[12].crop_top            = 360;
+	receive_scenarios[12].crop_right          = 1024;
+	receive_scenarios[12].crop_bottom         = 360;
+	receive_scenarios[12].min_recvs           = frame_count;
+	receive_scenarios[12].max_recvs           = frame_count;
+	receive_scenarios[12].max_received_pixels = frame_count * 512 * 720;
+
+	receive_scenarios[13].name                = "TsvReceiveSource (crop, shared memory)";
+	receive_scenarios[13].publish_interval    = 1;
+	receive_scenarios[13].transport           = TsvReceiveSource::TRANSPORT_SHARED_MEMORY;
+	receive_scenarios[13].crop_left           = 1024;
+	receive_scenarios[13].crop_top            = 360;
+	receive_scenarios[13].crop_right          = 1024;
+	receive_scenarios[13].crop_bottom         = 360;
+	receive_scenarios[13].min_recvs           = frame_count;
+	receive_scenarios[13].max_recvs           = frame_count;
+	receive_scenarios[13].max_received_pixels = frame_count * 512 * 720;
+
+	// Sender toggles between two resolutions while frames are held back. The first frame at the new size is drawn
+	// right away, the previous size is drawn until it was received. Only the first switches allocate the texture and
+	// the three jitter buffer slots of each size
+	receive_scenarios[14].name              = "TsvReceiveSource (resize, jitter buffer)";
+	receive_scenarios[14].publish_interval  = 1;
+	receive_scenarios[14].resize_interval   = 60;
+	receive_scenarios[14].jitter_buffer     = 2;
+	receive_scenarios[14].min_recvs         = frame_count;
+	receive_scenarios[14].max_recvs         = frame_count;
+	receive_scenarios[14].max_allocations   = 7;
+	receive_scenarios[14].draw_every_render = true;
+
+	// Sender's conversions are undone by the draw, packed images while unpacking
+	receive_scenarios[15].name                 = "TsvReceiveSource (conversions)";
+	receive_scenarios[15].publish_interval     = 1;
+	receive_scenarios[15].conversion           = ALL_CONVERSIONS;
+	receive_scenarios[15].min_recvs            = frame_count;
+	receive_scenarios[15].max_recvs            = frame_count;
+	receive_scenarios[15].max_passes           = frame_count;
+	receive_scenarios[15].min_converted_passes = frame_count;
+
+	receive_scenarios[16].name                 = "TsvReceiveSource (NV12, conversions)";
+	receive_scenarios[16].publish_interval     = 1;
+	receive_scenarios[16].layout               = TsvPixelLayout::NV12;
+	receive_scenarios[16].conversion           = ALL_CONVERSIONS;
+	receive_scenarios[16].min_recvs            = frame_count;
+	receive_scenarios[16].max_recvs            = frame_count;
+	receive_scenarios[16].max_passes           = frame_count;
+	receive_scenarios[16].min_converted_passes = frame_count;
+
+	// Source in an unused scene. Only the frame after the warm up draw announces a consumer and copies a frame
+	receive_scenarios[17].name              = "TsvReceiveSource (hidden)";
+	receive_scenarios[17].publish_interval  = 1;
+	receive_scenarios[17].prefetch          = true;
+	receive_scenarios[17].hidden            = true;
+	receive_scenarios[17].min_recvs         = 0;
+	receive_scenarios[17].max_recvs         = 1;
+	receive_scenarios[17].max_announcements = 1;
+
+	for(const ReceiveSourceScenario &scenario : receive_scenarios)
+	{
+		const BenchmarkResult result = BenchmarkReceiveSource(frame_count, scenario);
+		CheckRecvCount(scenario, result);
+		PrintResult(scenario.name, result);
+	}
+
+	return EXIT_SUCCESS;
+}
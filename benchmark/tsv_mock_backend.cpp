@@ -0,0 +1,741 @@
+#include "tsv_mock_backend.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace
+{
+	// Like the module wide texture share client, a batch begun on any mock covers the sends of all mocks
+	thread_local uint32_t send_batch_depth = 0;
+} // namespace
+
+
+uint64_t TsvMockBackend::CallCounts::Total() const
+{
+	return this->init_client + this->init_image + this->find_image + this->find_image_data + this->send_image +
+	       this->recv_image;
+}
+
+TsvMockBackend::CallCounts &TsvMockBackend::CallCounts::operator+=(const CallCounts &other)
+{
+	this->init_client += other.init_client;
+	this->init_image += other.init_image;
+	this->find_image += other.find_image;
+	this->find_image_data += other.find_image_data;
+	this->send_image += other.send_image;
+	this->recv_image += other.recv_image;
+	this->send_batches += other.send_batches;
+	this->batched_sends += other.batched_sends;
+	this->gpu_allocations += other.gpu_allocations;
+	this->write_cpu_frame += other.write_cpu_frame;
+	this->map_cpu_frame += other.map_cpu_frame;
+	this->sent_pixels += other.sent_pixels;
+	this->received_pixels += other.received_pixels;
+	this->copied_pixels += other.copied_pixels;
+	this->draws += other.draws;
+	this->consumer_announcements += other.consumer_announcements;
+	this->passes += other.passes;
+	this->converted_passes += other.converted_passes;
+	this->lossy_passes += other.lossy_passes;
+
+	return *this;
+}
+
+void TsvMockBackend::SetSourceSize(uint32_t width, uint32_t height)
+{
+	this->_source_width  = width;
+	this->_source_height = height;
+}
+
+void TsvMockBackend::SetSourceDamage(const TsvImageRect &damage)
+{
+	this->_source_damage = damage;
+}
+
+void TsvMockBackend::SetRenderSourceCallback(std::function<void()> callback)
+{
+	this->_render_source_callback = std::move(callback);
+}
+
+void TsvMockBackend::SetFenceLatency(uint32_t polls)
+{
+	this->_fence_latency = polls;
+}
+
+void TsvMockBackend::SetConnectLatency(uint64_t frames)
+{
+	this->_connect_latency = frames;
+}
+
+void TsvMockBackend::AdvanceVideoFrame()
+{
+	++this->_video_frame_index;
+
+	if(this->_source_damage.width > 0 && this->_source_damage.height > 0)
+		++this->_source_content;
+}
+
+void TsvMockBackend::SetVideoFrameRate(double frame_rate)
+{
+	this->_video_frame_rate = frame_rate;
+}
+
+void TsvMockBackend::PublishImage(const std::string &name, uint32_t width, uint32_t height, ImgFormat format)
+{
+	MockImage &image  = this->_images[name];
+	image.data.width  = width;
+	image.data.height = height;
+	image.data.format = format;
+	++image.version;
+
+	this->NotifyImageWatches(name);
+}
+
+const TsvMockBackend::CallCounts &TsvMockBackend::GetCallCounts() const
+{
+	return this->_calls;
+}
+
+void TsvMockBackend::ResetCallCounts()
+{
+	this->_calls = CallCounts{};
+}
+
+size_t TsvMockBackend::GetSyncBlockCount()
+{
+	return GetSyncBlocks().size();
+}
+
+void TsvMockBackend::InitClient()
+{
+	++this->_calls.init_client;
+	if(this->_connect_frame == NO_CONNECTION)
+		this->_connect_frame = this->_video_frame_index + this->_connect_latency;
+}
+
+bool TsvMockBackend::IsClientConnected()
+{
+	return this->_connect_frame != NO_CONNECTION && this->_video_frame_index >= this->_connect_frame;
+}
+
+bool TsvMockBackend::InitImage(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+                               bool overwrite_existing)
+{
+	++this->_calls.init_image;
+
+	const auto image_it = this->_images.find(name);
+	if(image_it != this->_images.end() && !overwrite_existing)
+		return false;
+
+	this->PublishImage(name, width, height, format);
+	this->_seen_versions[name] = this->_images[name].version;
+	return true;
+}
+
+ImageLookupResult TsvMockBackend::FindImage(const char *name, bool force_update)
+{
+	++this->_calls.find_image;
+
+	const auto image_it = this->_images.find(name);
+	if(image_it == this->_images.end())
+		return ImageLookupResult::NotFound;
+
+	uint64_t &seen_version = this->_seen_versions[name];
+	if(seen_version != image_it->second.version)
+	{
+		if(!force_update)
+			return ImageLookupResult::RequiresUpdate;
+
+		seen_version = image_it->second.version;
+	}
+
+	return ImageLookupResult::Found;
+}
+
+bool TsvMockBackend::FindImageData(const char *name, bool force_update, TsvImageData &data)
+{
+	++this->_calls.find_image_data;
+
+	const auto image_it = this->_images.find(name);
+	if(image_it == this->_images.end())
+		return false;
+
+	if(force_update)
+		this->_seen_versions[name] = image_it->second.version;
+
+	data = image_it->second.data;
+	return true;
+}
+
+bool TsvMockBackend::SendImage(const char *name, gs_texture_t *texture, const TsvImageRect &region)
+{
+	++this->_calls.send_image;
+	if(send_batch_depth > 0)
+		++this->_calls.batched_sends;
+
+	const auto image_it = this->_images.find(name);
+	if(image_it == this->_images.end() || !texture)
+		return false;
+
+	const MockTexture *const mock_texture = reinterpret_cast<const MockTexture *>(texture);
+	if(!IsInside(region, image_it->second.data.width, image_it->second.data.height) ||
+	   !IsInside(region, mock_texture->width, mock_texture->height))
+		return false;
+
+	this->_calls.sent_pixels += static_cast<uint64_t>(region.width) * region.height;
+	image_it->second.frame = mock_texture->frame;
+	return true;
+}
+
+bool TsvMockBackend::RecvImage(const char *name, gs_texture_t *texture, const TsvImageRect &region, uint32_t dst_x,
+                               uint32_t dst_y)
+{
+	++this->_calls.recv_image;
+
+	const auto image_it = this->_images.find(name);
+	if(image_it == this->_images.end() || !texture)
+		return false;
+
+	MockTexture *const mock_texture = reinterpret_cast<MockTexture *>(texture);
+	if(!IsInside(region, image_it->second.data.width, image_it->second.data.height) ||
+	   !IsInside({dst_x, dst_y, region.width, region.height}, mock_texture->width, mock_texture->height))
+		return false;
+
+	this->_calls.received_pixels += static_cast<uint64_t>(region.width) * region.height;
+	mock_texture->frame = image_it->second.frame;
+	return true;
+}
+
+void TsvMockBackend::BeginSendBatch()
+{
+	if(send_batch_depth++ == 0)
+		++this->_calls.send_batches;
+}
+
+void TsvMockBackend::EndSendBatch()
+{
+	if(send_batch_depth > 0)
+		--send_batch_depth;
+}
+
+void TsvMockBackend::AnnounceConsumer(const char *name)
+{
+	// Consumers don't create synchronization blocks
+	const auto block_it = GetSyncBlocks().find(name);
+	if(block_it == GetSyncBlocks().end())
+		return;
+
+	++this->_calls.consumer_announcements;
+	block_it->second = std::chrono::steady_clock::now();
+}
+
+bool TsvMockBackend::HasConsumer(const char *name, std::chrono::nanoseconds timeout)
+{
+	const auto [block_it, created] = GetSyncBlocks().try_emplace(name);
+	if(created)
+		return false;
+
+	return std::chrono::steady_clock::now() - block_it->second <= timeout;
+}
+
+void TsvMockBackend::PublishFrame(const char *name, const TsvImageRect &damage, uint64_t timestamp_ns)
+{
+	GetSyncBlocks().try_emplace(name);
+	const uint64_t generation     = ++this->_frame_generations[name];
+	this->_published_frames[name] = MockPublishedFrame{generation, damage, timestamp_ns};
+}
+
+uint64_t TsvMockBackend::GetFrameGeneration(const char *name)
+{
+	const auto generation_it = this->_frame_generations.find(name);
+	if(generation_it == this->_frame_generations.end())
+		return TsvImageSync::UNKNOWN_GENERATION;
+
+	return generation_it->second;
+}
+
+bool TsvMockBackend::GetFrameDamage(const char *name, uint64_t generation, TsvImageRect &damage)
+{
+	const auto frame_it = this->_published_frames.find(name);
+	if(frame_it == this->_published_frames.end() || frame_it->second.generation != generation)
+		return false;
+
+	damage = frame_it->second.damage;
+	return true;
+}
+
+uint64_t TsvMockBackend::GetFrameTimestamp(const char *name, uint64_t generation)
+{
+	const auto frame_it = this->_published_frames.find(name);
+	if(frame_it == this->_published_frames.end() || frame_it->second.generation != generation)
+		return TsvImageSync::UNKNOWN_TIMESTAMP;
+
+	return frame_it->second.timestamp_ns;
+}
+
+void TsvMockBackend::PublishImageInfo(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+                                      TsvPixelLayout::LAYOUT layout)
+{
+	GetSyncBlocks().try_emplace(name);
+
+	const auto info_it = this->_image_infos.find(name);
+	if(info_it != this->_image_infos.end() && info_it->second.data.width == width &&
+	   info_it->second.data.height == height && info_it->second.data.format == format &&
+	   info_it->second.layout == layout)
+		return;
+
+	this->_image_infos[name] = MockImageInfo{TsvImageData{width, height, format}, layout};
+	this->NotifyImageWatches(name);
+}
+
+bool TsvMockBackend::GetImageLayout(const char *name, TsvPixelLayout::LAYOUT &layout, uint32_t &width,
+                                    uint32_t &height)
+{
+	const auto info_it = this->_image_infos.find(name);
+	if(info_it == this->_image_infos.end())
+		return false;
+
+	layout = info_it->second.layout;
+	width  = info_it->second.data.width;
+	height = info_it->second.data.height;
+	return true;
+}
+
+void TsvMockBackend::RevokeImageInfo(const char *name)
+{
+	GetSyncBlocks().erase(name);
+	if(this->_image_infos.erase(name) > 0)
+		this->NotifyImageWatches(name);
+}
+
+void TsvMockBackend::WatchImage(const void *owner, const char *name, image_changed_callback_t callback)
+{
+	MockImageWatch &watch = this->_image_watches[owner];
+	watch.name            = name;
+	watch.callback        = std::move(callback);
+
+	// The watcher thread reports already existing images on its first check
+	if(this->_images.count(name) > 0)
+		watch.callback();
+}
+
+void TsvMockBackend::UnwatchImage(const void *owner)
+{
+	this->_image_watches.erase(owner);
+}
+
+bool TsvMockBackend::WriteCpuFrame(const char *name, const uint8_t * /*data*/, uint32_t width, uint32_t height,
+                                   uint32_t linesize, gs_color_format format)
+{
+	if(width == 0 || height == 0 || linesize == 0)
+		return false;
+
+	++this->_calls.write_cpu_frame;
+	this->_calls.sent_pixels += static_cast<uint64_t>(width) * height;
+
+	MockCpuFrame &cpu_frame = this->_cpu_frames[name];
+	cpu_frame.data.resize(static_cast<size_t>(linesize) * height);
+
+	cpu_frame.frame.data     = cpu_frame.data.data();
+	cpu_frame.frame.width    = width;
+	cpu_frame.frame.height   = height;
+	cpu_frame.frame.linesize = linesize;
+	cpu_frame.frame.format   = format;
+	++cpu_frame.frame.sequence;
+
+	return true;
+}
+
+void TsvMockBackend::RevokeCpuFrames(const char *name)
+{
+	this->_cpu_frames.erase(name);
+}
+
+bool TsvMockBackend::MapCpuFrame(const char *name, uint64_t after_sequence, TsvCpuFrame &frame)
+{
+	const auto cpu_frame_it = this->_cpu_frames.find(name);
+	if(cpu_frame_it == this->_cpu_frames.end() || cpu_frame_it->second.frame.sequence == after_sequence)
+		return false;
+
+	++this->_calls.map_cpu_frame;
+	frame = cpu_frame_it->second.frame;
+	return true;
+}
+
+bool TsvMockBackend::UnmapCpuFrame(const char * /*name*/, const TsvCpuFrame & /*frame*/)
+{
+	return true;
+}
+
+void TsvMockBackend::EnterGraphics()
+{
+	++this->_graphics_depth;
+}
+
+void TsvMockBackend::LeaveGraphics()
+{
+	assert(this->_graphics_depth > 0);
+	--this->_graphics_depth;
+}
+
+void TsvMockBackend::AddMainRenderCallback(main_render_callback_t callback, void *param)
+{
+	this->_main_render_callback = callback;
+	this->_main_render_param    = param;
+}
+
+void TsvMockBackend::RemoveMainRenderCallback(main_render_callback_t callback, void *param)
+{
+	if(this->_main_render_callback == callback && this->_main_render_param == param)
+	{
+		this->_main_render_callback = nullptr;
+		this->_main_render_param    = nullptr;
+	}
+}
+
+uint64_t TsvMockBackend::GetVideoFrameIndex()
+{
+	return this->_video_frame_index;
+}
+
+double TsvMockBackend::GetVideoFrameRate()
+{
+	return this->_video_frame_rate;
+}
+
+uint64_t TsvMockBackend::GetVideoFrameTime()
+{
+	// Starts at one frame interval, a time of 0 is an unknown timestamp. Whole nanoseconds per frame keep frame
+	// intervals exact
+	const uint64_t frame_interval_ns = static_cast<uint64_t>(1e9 / this->_video_frame_rate);
+	return (this->_video_frame_index + 1) * frame_interval_ns;
+}
+
+uint32_t TsvMockBackend::GetSourceWidth(obs_source_t * /*source*/)
+{
+	return this->_source_width;
+}
+
+uint32_t TsvMockBackend::GetSourceHeight(obs_source_t * /*source*/)
+{
+	return this->_source_height;
+}
+
+void TsvMockBackend::SkipVideoFilter(obs_source_t * /*filter*/)
+{}
+
+void TsvMockBackend::RenderSource(obs_source_t * /*source*/, uint32_t /*width*/, uint32_t /*height*/,
+                                  const TsvConversion &conversion)
+{
+	// Fused into the texrender pass the source is rendered in
+	if(conversion.flip_vertical || conversion.premultiply_alpha)
+		++this->_calls.converted_passes;
+
+	if(this->_render_source_callback)
+		this->_render_source_callback();
+}
+
+bool TsvMockBackend::CaptureFilterInput(obs_source_t * /*filter*/, gs_texrender_t *texrender, uint32_t width,
+                                        uint32_t height, gs_color_format /*format*/, const TsvConversion &conversion)
+{
+	if(!this->BeginTexrender(texrender, width, height))
+		return false;
+
+	if(!conversion.IsIdentity())
+		++this->_calls.converted_passes;
+
+	this->EndTexrender(texrender);
+	return true;
+}
+
+gs_texrender_t *TsvMockBackend::CreateTexrender(uint32_t width, uint32_t height, gs_color_format format)
+{
+	void *const pooled = this->_texture_pool.Take({TsvTexturePool::TEXRENDER, width, height, format});
+	if(pooled)
+		return reinterpret_cast<gs_texrender_t *>(pooled);
+
+	++this->_calls.gpu_allocations;
+
+	MockTexrender *const texrender = new MockTexrender();
+	texrender->texture.format      = format;
+	return reinterpret_cast<gs_texrender_t *>(texrender);
+}
+
+void TsvMockBackend::DestroyTexrender(gs_texrender_t *texrender)
+{
+	MockTexrender *const mock_texrender = reinterpret_cast<MockTexrender *>(texrender);
+	if(mock_texrender->texture.width == 0 || mock_texrender->texture.height == 0)
+	{
+		delete mock_texrender;
+		return;
+	}
+
+	this->_texture_pool.Put({TsvTexturePool::TEXRENDER, mock_texrender->texture.width, mock_texrender->texture.height,
+	                         mock_texrender->texture.format},
+	                        texrender);
+}
+
+bool TsvMockBackend::BeginTexrender(gs_texrender_t *texrender, uint32_t width, uint32_t height)
+{
+	if(!texrender || width == 0 || height == 0)
+		return false;
+
+	MockTexrender *const mock_texrender = reinterpret_cast<MockTexrender *>(texrender);
+	mock_texrender->texture.width       = width;
+	mock_texrender->texture.height      = height;
+	++this->_calls.passes;
+	return true;
+}
+
+void TsvMockBackend::EndTexrender(gs_texrender_t *texrender)
+{
+	// Only used for rendering the source
+	MockTexture &texture = reinterpret_cast<MockTexrender *>(texrender)->texture;
+	++texture.frame;
+	texture.content = this->_source_content;
+	texture.damage  = this->_source_damage;
+}
+
+gs_texture_t *TsvMockBackend::GetTexrenderTexture(gs_texrender_t *texrender)
+{
+	return reinterpret_cast<gs_texture_t *>(&reinterpret_cast<MockTexrender *>(texrender)->texture);
+}
+
+gs_texture_t *TsvMockBackend::CreateTexture(uint32_t width, uint32_t height, gs_color_format format)
+{
+	void *const pooled = this->_texture_pool.Take({TsvTexturePool::TEXTURE, width, height, format});
+	if(pooled)
+		return reinterpret_cast<gs_texture_t *>(pooled);
+
+	++this->_calls.gpu_allocations;
+
+	MockTexture *const texture = new MockTexture();
+	texture->width             = width;
+	texture->height            = height;
+	texture->format            = format;
+	return reinterpret_cast<gs_texture_t *>(texture);
+}
+
+void TsvMockBackend::DestroyTexture(gs_texture_t *texture)
+{
+	if(!texture)
+		return;
+
+	const MockTexture *const mock_texture = reinterpret_cast<const MockTexture *>(texture);
+	this->_texture_pool.Put({TsvTexturePool::TEXTURE, mock_texture->width, mock_texture->height, mock_texture->format},
+	                        texture);
+}
+
+gs_texture_t *TsvMockBackend::CreateDynamicTexture(uint32_t width, uint32_t height, gs_color_format format)
+{
+	++this->_calls.gpu_allocations;
+
+	MockTexture *const texture = new MockTexture();
+	texture->width             = width;
+	texture->height            = height;
+	texture->format            = format;
+	return reinterpret_cast<gs_texture_t *>(texture);
+}
+
+void TsvMockBackend::DestroyDynamicTexture(gs_texture_t *texture)
+{
+	delete reinterpret_cast<MockTexture *>(texture);
+}
+
+void TsvMockBackend::SetTextureImage(gs_texture_t *texture, const uint8_t * /*data*/, uint32_t /*linesize*/)
+{
+	// Uploads the whole texture
+	const MockTexture *const mock_texture = reinterpret_cast<const MockTexture *>(texture);
+	this->_calls.received_pixels += static_cast<uint64_t>(mock_texture->width) * mock_texture->height;
+}
+
+void TsvMockBackend::CopyTexture(gs_texture_t *dst, gs_texture_t *texture)
+{
+	if(!dst || !texture)
+		return;
+
+	MockTexture *const mock_dst           = reinterpret_cast<MockTexture *>(dst);
+	const MockTexture *const mock_texture = reinterpret_cast<const MockTexture *>(texture);
+	this->_calls.copied_pixels += static_cast<uint64_t>(mock_texture->width) * mock_texture->height;
+	mock_dst->frame                       = mock_texture->frame;
+	mock_dst->content                     = mock_texture->content;
+	mock_dst->damage                      = mock_texture->damage;
+}
+
+void TsvMockBackend::DrawTexture(gs_texture_t *texture, const TsvConversion &conversion)
+{
+	++this->_calls.draws;
+	++this->_calls.passes;
+	if(!conversion.IsIdentity())
+		++this->_calls.converted_passes;
+
+	const MockTexture *const mock_texture = reinterpret_cast<const MockTexture *>(texture);
+	if(conversion.inverse && (conversion.linear_color || conversion.premultiply_alpha) && mock_texture &&
+	   mock_texture->format == GS_RGBA)
+		++this->_calls.lossy_passes;
+}
+
+bool TsvMockBackend::DownscaleTexture(gs_texture_t *texture, gs_texrender_t *texrender, uint32_t width,
+                                      uint32_t height)
+{
+	if(!texture || !this->BeginTexrender(texrender, width, height))
+		return false;
+
+	// Carry the source frame over to the downscaled texture
+	MockTexrender *const mock_texrender = reinterpret_cast<MockTexrender *>(texrender);
+	mock_texrender->texture.frame       = reinterpret_cast<const MockTexture *>(texture)->frame;
+	return true;
+}
+
+bool TsvMockBackend::PackTexture(gs_texture_t *texture, gs_texrender_t *texrender, TsvPixelLayout::LAYOUT layout,
+                                 uint32_t width, uint32_t height)
+{
+	uint32_t packed_width, packed_height;
+	TsvPixelLayout::GetPackedSize(layout, width, height, packed_width, packed_height);
+	if(!texture || !this->BeginTexrender(texrender, packed_width, packed_height))
+		return false;
+
+	// Carry the source frame over to the packed texture
+	MockTexrender *const mock_texrender = reinterpret_cast<MockTexrender *>(texrender);
+	mock_texrender->texture.frame       = reinterpret_cast<const MockTexture *>(texture)->frame;
+	return true;
+}
+
+void TsvMockBackend::DrawPackedTexture(gs_texture_t * /*texture*/, TsvPixelLayout::LAYOUT /*layout*/,
+                                       uint32_t /*width*/, uint32_t /*height*/, const TsvConversion &conversion)
+{
+	++this->_calls.draws;
+	++this->_calls.passes;
+	if(!conversion.IsIdentity())
+		++this->_calls.converted_passes;
+}
+
+bool TsvMockBackend::CompareTiles(gs_texture_t *texture, gs_texture_t *previous, gs_texrender_t *texrender,
+                                  uint32_t tile_size)
+{
+	if(!texture || !previous || tile_size == 0)
+		return false;
+
+	const MockTexture *const mock_texture  = reinterpret_cast<const MockTexture *>(texture);
+	const MockTexture *const mock_previous = reinterpret_cast<const MockTexture *>(previous);
+
+	const uint32_t tiles_x = (mock_texture->width + tile_size - 1) / tile_size;
+	const uint32_t tiles_y = (mock_texture->height + tile_size - 1) / tile_size;
+	if(!this->BeginTexrender(texrender, tiles_x, tiles_y))
+		return false;
+
+	// Changed tiles, clipped to the texture
+	MockTexture &tiles = reinterpret_cast<MockTexrender *>(texrender)->texture;
+	tiles.damage       = TsvImageRect{};
+	if(mock_texture->content != mock_previous->content)
+	{
+		const TsvImageRect &damage = mock_texture->damage;
+
+		const uint64_t x1 = std::min<uint64_t>(static_cast<uint64_t>(damage.x) + damage.width, mock_texture->width);
+		const uint64_t y1 = std::min<uint64_t>(static_cast<uint64_t>(damage.y) + damage.height, mock_texture->height);
+
+		const uint32_t tiles_x1 = static_cast<uint32_t>((x1 + tile_size - 1) / tile_size);
+		const uint32_t tiles_y1 = static_cast<uint32_t>((y1 + tile_size - 1) / tile_size);
+
+		tiles.damage.x      = std::min(damage.x / tile_size, tiles_x);
+		tiles.damage.y      = std::min(damage.y / tile_size, tiles_y);
+		tiles.damage.width  = std::max(tiles_x1, tiles.damage.x) - tiles.damage.x;
+		tiles.damage.height = std::max(tiles_y1, tiles.damage.y) - tiles.damage.y;
+	}
+
+	return true;
+}
+
+gs_stagesurf_t *TsvMockBackend::CreateStageSurface(uint32_t width, uint32_t height, gs_color_format format)
+{
+	++this->_calls.gpu_allocations;
+
+	MockStageSurface *const stagesurf = new MockStageSurface();
+	stagesurf->width                  = width;
+	stagesurf->format                 = format;
+	stagesurf->data.resize(static_cast<size_t>(width) * height);
+	return reinterpret_cast<gs_stagesurf_t *>(stagesurf);
+}
+
+void TsvMockBackend::DestroyStageSurface(gs_stagesurf_t *stagesurf)
+{
+	delete reinterpret_cast<MockStageSurface *>(stagesurf);
+}
+
+void TsvMockBackend::StageTexture(gs_stagesurf_t *stagesurf, gs_texture_t *texture)
+{
+	MockStageSurface *const mock_stagesurf = reinterpret_cast<MockStageSurface *>(stagesurf);
+	const TsvImageRect &damage             = reinterpret_cast<const MockTexture *>(texture)->damage;
+	if(mock_stagesurf->format != GS_R8)
+		return;
+
+	std::fill(mock_stagesurf->data.begin(), mock_stagesurf->data.end(), 0);
+	for(uint32_t y = damage.y; y < damage.y + damage.height; ++y)
+	{
+		const auto row = mock_stagesurf->data.begin() + static_cast<size_t>(y) * mock_stagesurf->width;
+		std::fill(row + damage.x, row + damage.x + damage.width, 0xFF);
+	}
+}
+
+bool TsvMockBackend::MapStageSurface(gs_stagesurf_t *stagesurf, const uint8_t *&data, uint32_t &linesize)
+{
+	const MockStageSurface *const mock_stagesurf = reinterpret_cast<const MockStageSurface *>(stagesurf);
+	data                                         = mock_stagesurf->data.data();
+	linesize                                     = mock_stagesurf->width;
+	return true;
+}
+
+void TsvMockBackend::UnmapStageSurface(gs_stagesurf_t * /*stagesurf*/)
+{}
+
+TsvBackend::fence_t TsvMockBackend::CreateFence()
+{
+	MockFence *const fence = new MockFence();
+	fence->remaining_polls = this->_fence_latency;
+	return reinterpret_cast<fence_t>(fence);
+}
+
+bool TsvMockBackend::IsFenceSignaled(fence_t fence)
+{
+	MockFence *const mock_fence = reinterpret_cast<MockFence *>(fence);
+	if(mock_fence->remaining_polls == 0)
+		return true;
+
+	--mock_fence->remaining_polls;
+	return false;
+}
+
+void TsvMockBackend::DestroyFence(fence_t fence)
+{
+	delete reinterpret_cast<MockFence *>(fence);
+}
+
+void TsvMockBackend::NotifyImageWatches(const std::string &name)
+{
+	for(auto &[owner, watch] : this->_image_watches)
+	{
+		if(watch.name == name)
+			watch.callback();
+	}
+}
+
+std::map<std::string, std::chrono::steady_clock::time_point> &TsvMockBackend::GetSyncBlocks()
+{
+	static std::map<std::string, std::chrono::steady_clock::time_point> sync_blocks;
+	return sync_blocks;
+}
+
+bool TsvMockBackend::IsInside(const TsvImageRect &region, uint32_t width, uint32_t height)
+{
+	return region.x <= width && region.width <= width - region.x && region.y <= height &&
+	       region.height <= height - region.y;
+}
+
+void TsvMockBackend::DestroyPooledResource(TsvTexturePool::RESOURCE_TYPE type, void *resource)
+{
+	if(type == TsvTexturePool::TEXRENDER)
+		delete reinterpret_cast<MockTexrender *>(resource);
+	else
+		delete reinterpret_cast<MockTexture *>(resource);
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include "obs_plugin_texture_share_vk/tsv_backend.hpp"
+#include "obs_plugin_texture_share_vk/tsv_texture_pool.hpp"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/*! \brief In-memory backend. Keeps track of shared images and counts client calls. Does not require a GPU or a
+ * running OBS instance
+ */
+class TsvMockBackend : public TsvBackend
+{
+	public:
+	struct CallCounts
+	{
+		uint64_t init_client     = 0;
+		uint64_t init_image      = 0;
+		uint64_t find_image      = 0;
+		uint64_t find_image_data = 0;
+		uint64_t send_image      = 0;
+		uint64_t recv_image      = 0;
+
+		// Send batches, and send_image calls made within one. Not client calls
+		uint64_t send_batches  = 0;
+		uint64_t batched_sends = 0;
+
+		// Textures and texrenders that were not served from the texture pool. Not a client call
+		uint64_t gpu_allocations = 0;
+
+		// Frames written to and successfully mapped from CPU frame rings. Not client calls
+		uint64_t write_cpu_frame = 0;
+		uint64_t map_cpu_frame   = 0;
+
+		// Pixels copied by send_image and recv_image, or written to and uploaded from CPU frame rings
+		uint64_t sent_pixels     = 0;
+		uint64_t received_pixels = 0;
+
+		// Pixels copied between textures on the GPU, e.g. into a jitter buffer
+		uint64_t copied_pixels = 0;
+
+		// Textures drawn. Not a client call
+		uint64_t draws = 0;
+
+		// Consumer heartbeats written. Not a client call
+		uint64_t consumer_announcements = 0;
+
+		// Passes rendered into texrenders, and draws. Passes that applied a conversion are counted again in
+		// converted_passes. Not client calls
+		uint64_t passes           = 0;
+		uint64_t converted_passes = 0;
+
+		// Draws that undo linear colors or premultiplied alpha of an 8-bit texture, which loses precision. Not a client
+		// call
+		uint64_t lossy_passes = 0;
+
+		/*! \brief Total number of client calls
+		 */
+		uint64_t Total() const;
+
+		CallCounts &operator+=(const CallCounts &other);
+	};
+
+	TsvMockBackend()           = default;
+	~TsvMockBackend() override = default;
+
+	/*! \brief Set size returned by GetSourceWidth/GetSourceHeight
+	 */
+	void SetSourceSize(uint32_t width, uint32_t height);
+
+	/*! \brief Region of the source that changes with every video frame. An empty region emulates a static source.
+	 * By default, the whole source changes
+	 */
+	void SetSourceDamage(const TsvImageRect &damage);
+
+	/*! \brief Called by RenderSource. Used to emulate OBS calling back into the filter chain
+	 */
+	void SetRenderSourceCallback(std::function<void()> callback);
+
+	/*! \brief Number of IsFenceSignaled polls before a fence signals. Emulates GPU latency
+	 */
+	void SetFenceLatency(uint32_t polls);
+
+	/*! \brief Number of video frames after InitClient until the client is connected. Emulates a slow server launch
+	 */
+	void SetConnectLatency(uint64_t frames);
+
+	/*! \brief Start the next video frame
+	 */
+	void AdvanceVideoFrame();
+
+	void SetVideoFrameRate(double frame_rate);
+
+	/*! \brief Simulate an external process creating or resizing a shared image. Notifies watching receivers
+	 */
+	void PublishImage(const std::string &name, uint32_t width, uint32_t height, ImgFormat format);
+
+	const CallCounts &GetCallCounts() const;
+	void ResetCallCounts();
+
+	/*! \brief Number of synchronization blocks. Shared by all mock backends, like /dev/shm is shared by all processes:
+	 * senders create blocks when publishing or checking for consumers, RevokeImageInfo removes them
+	 */
+	static size_t GetSyncBlockCount();
+
+	void InitClient() override;
+	bool IsClientConnected() override;
+	bool InitImage(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+	               bool overwrite_existing) override;
+	ImageLookupResult FindImage(const char *name, bool force_update) override;
+	bool FindImageData(const char *name, bool force_update, TsvImageData &data) override;
+	bool SendImage(const char *name, gs_texture_t *texture, const TsvImageRect &region) override;
+	bool RecvImage(const char *name, gs_texture_t *texture, const TsvImageRect &region, uint32_t dst_x,
+	               uint32_t dst_y) override;
+	void BeginSendBatch() override;
+	void EndSendBatch() override;
+
+	void AnnounceConsumer(const char *name) override;
+	bool HasConsumer(const char *name, std::chrono::nanoseconds timeout) override;
+	void PublishFrame(const char *name, const TsvImageRect &damage, uint64_t timestamp_ns) override;
+	uint64_t GetFrameGeneration(const char *name) override;
+	bool GetFrameDamage(const char *name, uint64_t generation, TsvImageRect &damage) override;
+	uint64_t GetFrameTimestamp(const char *name, uint64_t generation) override;
+	void PublishImageInfo(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+	                      TsvPixelLayout::LAYOUT layout) override;
+	bool GetImageLayout(const char *name, TsvPixelLayout::LAYOUT &layout, uint32_t &width, uint32_t &height) override;
+	void RevokeImageInfo(const char *name) override;
+	void WatchImage(const void *owner, const char *name, image_changed_callback_t callback) override;
+	void UnwatchImage(const void *owner) override;
+
+	bool WriteCpuFrame(const char *name, const uint8_t *data, uint32_t width, uint32_t height, uint32_t linesize,
+	                   gs_color_format format) override;
+	void RevokeCpuFrames(const char *name) override;
+	bool MapCpuFrame(const char *name, uint64_t after_sequence, TsvCpuFrame &frame) override;
+	bool UnmapCpuFrame(const char *name, const TsvCpuFrame &frame) override;
+
+	void EnterGraphics() override;
+	void LeaveGraphics() override;
+
+	void AddMainRenderCallback(main_render_callback_t callback, void *param) override;
+	void RemoveMainRenderCallback(main_render_callback_t callback, void *param) override;
+
+	uint64_t GetVideoFrameIndex() override;
+	double GetVideoFrameRate() override;
+	uint64_t GetVideoFrameTime() override;
+
+	uint32_t GetSourceWidth(obs_source_t *source) override;
+	uint32_t GetSourceHeight(obs_source_t *source) override;
+
+	void SkipVideoFilter(obs_source_t *filter) override;
+	void RenderSource(obs_source_t *source, uint32_t width, uint32_t height, const TsvConversion &conversion) override;
+	bool CaptureFilterInput(obs_source_t *filter, gs_texrender_t *texrender, uint32_t width, uint32_t height,
+	                        gs_color_format format, const TsvConversion &conversion) override;
+
+	gs_texrender_t *CreateTexrender(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyTexrender(gs_texrender_t *texrender) override;
+	bool BeginTexrender(gs_texrender_t *texrender, uint32_t width, uint32_t height) override;
+	void EndTexrender(gs_texrender_t *texrender) override;
+	gs_texture_t *GetTexrenderTexture(gs_texrender_t *texrender) override;
+
+	gs_texture_t *CreateTexture(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyTexture(gs_texture_t *texture) override;
+
+	gs_texture_t *CreateDynamicTexture(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyDynamicTexture(gs_texture_t *texture) override;
+	void SetTextureImage(gs_texture_t *texture, const uint8_t *data, uint32_t linesize) override;
+
+	void CopyTexture(gs_texture_t *dst, gs_texture_t *texture) override;
+	void DrawTexture(gs_texture_t *texture, const TsvConversion &conversion) override;
+	bool DownscaleTexture(gs_texture_t *texture, gs_texrender_t *texrender, uint32_t width, uint32_t height) override;
+	bool PackTexture(gs_texture_t *texture, gs_texrender_t *texrender, TsvPixelLayout::LAYOUT layout, uint32_t width,
+	                 uint32_t height) override;
+	void DrawPackedTexture(gs_texture_t *texture, TsvPixelLayout::LAYOUT layout, uint32_t width, uint32_t height,
+	                       const TsvConversion &conversion) override;
+
+	bool CompareTiles(gs_texture_t *texture, gs_texture_t *previous, gs_texrender_t *texrender,
+	                  uint32_t tile_size) override;
+
+	gs_stagesurf_t *CreateStageSurface(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyStageSurface(gs_stagesurf_t *stagesurf) override;
+	void StageTexture(gs_stagesurf_t *stagesurf, gs_texture_t *texture) override;
+	bool MapStageSurface(gs_stagesurf_t *stagesurf, const uint8_t *&data, uint32_t &linesize) override;
+	void UnmapStageSurface(gs_stagesurf_t *stagesurf) override;
+
+	fence_t CreateFence() override;
+	bool IsFenceSignaled(fence_t fence) override;
+	void DestroyFence(fence_t fence) override;
+
+	private:
+	static constexpr uint64_t NO_CONNECTION = UINT64_MAX;
+
+	struct MockTexture
+	{
+		uint32_t width         = 0;
+		uint32_t height        = 0;
+		gs_color_format format = GS_UNKNOWN;
+		uint64_t frame         = 0;
+
+		// Source content the texture was rendered from, and its region that changed relative to the previous content.
+		// For tile textures rendered by CompareTiles, damage is given in tiles
+		uint64_t content = 0;
+		TsvImageRect damage;
+	};
+
+	struct MockTexrender
+	{
+		MockTexture texture;
+	};
+
+	struct MockStageSurface
+	{
+		uint32_t width         = 0;
+		gs_color_format format = GS_UNKNOWN;
+
+		// One byte per pixel. Only GS_R8 surfaces receive the staged tiles, others stay empty
+		std::vector<uint8_t> data;
+	};
+
+	struct MockFence
+	{
+		uint32_t remaining_polls = 0;
+	};
+
+	struct MockImageWatch
+	{
+		std::string name;
+		image_changed_callback_t callback;
+	};
+
+	struct MockImageInfo
+	{
+		TsvImageData data;
+		TsvPixelLayout::LAYOUT layout = TsvPixelLayout::RGBA;
+	};
+
+	struct MockImage
+	{
+		TsvImageData data;
+		uint64_t version = 0;
+		uint64_t frame   = 0;
+	};
+
+	struct MockCpuFrame
+	{
+		// Frame content is not copied, data points to an empty buffer of the frame's size
+		TsvCpuFrame frame;
+		std::vector<uint8_t> data;
+	};
+
+	struct MockPublishedFrame
+	{
+		uint64_t generation = TsvImageSync::UNKNOWN_GENERATION;
+		TsvImageRect damage;
+		uint64_t timestamp_ns = TsvImageSync::UNKNOWN_TIMESTAMP;
+	};
+
+	CallCounts _calls;
+
+	std::map<std::string, MockImage> _images;
+
+	// Image versions last seen by this client. Used to emulate ImageLookupResult::RequiresUpdate
+	std::map<std::string, uint64_t> _seen_versions;
+
+	std::map<std::string, uint64_t> _frame_generations;
+	std::map<std::string, MockPublishedFrame> _published_frames;
+	std::map<std::string, MockCpuFrame> _cpu_frames;
+
+	// Published image info and watching receivers. Watch callbacks are called synchronously
+	std::map<std::string, MockImageInfo> _image_infos;
+	std::map<const void *, MockImageWatch> _image_watches;
+
+	TsvTexturePool _texture_pool{&TsvMockBackend::DestroyPooledResource};
+
+	uint32_t _source_width  = 0;
+	uint32_t _source_height = 0;
+
+	// Source content is advanced with every video frame unless the source damage is empty
+	TsvImageRect _source_damage{0, 0, UINT32_MAX, UINT32_MAX};
+	uint64_t _source_content = 0;
+
+	uint64_t _video_frame_index = 0;
+	double _video_frame_rate    = 60.0;
+
+	std::function<void()> _render_source_callback;
+
+	main_render_callback_t _main_render_callback = nullptr;
+	void *_main_render_param                     = nullptr;
+
+	uint32_t _graphics_depth = 0;
+	uint32_t _fence_latency  = 0;
+
+	// Video frame in which the client connects. NO_CONNECTION until InitClient was called
+	uint64_t _connect_latency = 0;
+	uint64_t _connect_frame   = NO_CONNECTION;
+
+	void NotifyImageWatches(const std::string &name);
+
+	/*! \brief Whether region lies within a width x height image
+	 */
+	static bool IsInside(const TsvImageRect &region, uint32_t width, uint32_t height);
+
+	/*! \brief Synchronization blocks of all mock backends, with the time of their last consumer heartbeat
+	 */
+	static std::map<std::string, std::chrono::steady_clock::time_point> &GetSyncBlocks();
+
+	static void DestroyPooledResource(TsvTexturePool::RESOURCE_TYPE type, void *resource);
+};
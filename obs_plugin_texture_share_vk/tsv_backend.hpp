@@ -0,0 +1,285 @@
+#pragma once
+
+#include "tsv_conversion.hpp"
+#include "tsv_image_sync.hpp"
+#include "tsv_pixel_layout.hpp"
+
+#include <obs-module.h>
+#include <texture_share_gl/texture_share_gl_client.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+/*! \brief Shared image information as published by the texture share server
+ */
+struct TsvImageData
+{
+	uint32_t width   = 0;
+	uint32_t height  = 0;
+	ImgFormat format = ImgFormat::R8G8B8A8;
+};
+
+/*! \brief CPU copy of a frame, mapped from a shared memory frame ring
+ */
+struct TsvCpuFrame
+{
+	const uint8_t *data    = nullptr;
+	uint32_t width         = 0;
+	uint32_t height        = 0;
+	uint32_t linesize      = 0;
+	gs_color_format format = GS_UNKNOWN;
+
+	// Increases with every written frame
+	uint64_t sequence = 0;
+
+	// CLOCK_MONOTONIC time at which the frame was written
+	uint64_t timestamp_ns = 0;
+};
+
+/*! \brief Thin interface over the texture share client and the OBS graphics calls used by TsvSendFilter and
+ * TsvReceiveSource. TsvObsBackend forwards to the real implementations, other backends (e.g. an in-memory mock) can be
+ * used to drive the plugins without a GPU
+ */
+class TsvBackend
+{
+	public:
+	using main_render_callback_t   = void (*)(void *param, uint32_t cx, uint32_t cy);
+	using fence_t                  = void *;
+	using image_changed_callback_t = std::function<void()>;
+
+	virtual ~TsvBackend() = default;
+
+	/*! \brief Start connecting to texture share server in the background. Launches server if none is running. Returns
+	 * immediately
+	 */
+	virtual void InitClient() = 0;
+
+	/*! \brief Whether the client is connected. No client calls may be made before. Cheap enough to be checked every
+	 * frame
+	 */
+	virtual bool IsClientConnected() = 0;
+
+	/*! \brief Create or resize a shared image
+	 */
+	virtual bool InitImage(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+	                       bool overwrite_existing) = 0;
+
+	virtual ImageLookupResult FindImage(const char *name, bool force_update) = 0;
+
+	/*! \brief Lookup shared image information. Returns false if no image with the given name exists
+	 */
+	virtual bool FindImageData(const char *name, bool force_update, TsvImageData &data) = 0;
+
+	/*! \brief Copy region of texture to the same region of the shared image
+	 */
+	virtual bool SendImage(const char *name, gs_texture_t *texture, const TsvImageRect &region) = 0;
+
+	/*! \brief Copy region of the shared image into texture, placing its top left corner at dst_x, dst_y. Textures
+	 * holding a cropped part of the shared image are smaller than the image
+	 */
+	virtual bool RecvImage(const char *name, gs_texture_t *texture, const TsvImageRect &region, uint32_t dst_x,
+	                       uint32_t dst_y) = 0;
+
+	/*! \brief Start a batch of SendImage calls from the render thread, e.g. the sends of all filters in one video
+	 * frame. Covers the calls of all backends of the module. Backends may set up the client once for the whole batch
+	 * instead of once per call. Must be followed by EndSendBatch
+	 */
+	virtual void BeginSendBatch() = 0;
+	virtual void EndSendBatch()   = 0;
+
+	/*! \brief Announce that this process reads the named shared image. Should be called periodically. Has no effect
+	 * until a sender of the image checked for consumers or published it
+	 */
+	virtual void AnnounceConsumer(const char *name) = 0;
+
+	/*! \brief Check whether any process announced itself as consumer of the named image within timeout
+	 */
+	virtual bool HasConsumer(const char *name, std::chrono::nanoseconds timeout) = 0;
+
+	/*! \brief Advance the frame generation of the named image. Called after each send with the region that changed
+	 * since the previous generation and the video frame time the frame was captured in
+	 */
+	virtual void PublishFrame(const char *name, const TsvImageRect &damage, uint64_t timestamp_ns) = 0;
+
+	/*! \brief Get the frame generation of the named image. Returns TsvImageSync::UNKNOWN_GENERATION if the sender
+	 * doesn't publish one
+	 */
+	virtual uint64_t GetFrameGeneration(const char *name) = 0;
+
+	/*! \brief Get the region of the named image that changed between the previous and the given generation. Returns
+	 * false if it is not known
+	 */
+	virtual bool GetFrameDamage(const char *name, uint64_t generation, TsvImageRect &damage) = 0;
+
+	/*! \brief Get the capture time of the given generation of the named image. Returns TsvImageSync::UNKNOWN_TIMESTAMP
+	 * if it is not known
+	 */
+	virtual uint64_t GetFrameTimestamp(const char *name, uint64_t generation) = 0;
+
+	/*! \brief Publish size, format and pixel layout of the named image to watching receivers. For packed layouts, width
+	 * and height are the size of the unpacked image. Called after (re-)creating the image
+	 */
+	virtual void PublishImageInfo(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+	                              TsvPixelLayout::LAYOUT layout) = 0;
+
+	/*! \brief Get pixel layout and unpacked size of the named image. Returns false if the sender doesn't publish image
+	 * info
+	 */
+	virtual bool GetImageLayout(const char *name, TsvPixelLayout::LAYOUT &layout, uint32_t &width,
+	                            uint32_t &height) = 0;
+
+	/*! \brief Notify watching receivers that the named image is no longer sent
+	 */
+	virtual void RevokeImageInfo(const char *name) = 0;
+
+	/*! \brief Call callback whenever the named image is created, resized or removed. Replaces a previous watch of the
+	 * same owner. The callback may be called from any thread
+	 */
+	virtual void WatchImage(const void *owner, const char *name, image_changed_callback_t callback) = 0;
+
+	/*! \brief Remove watch of owner. Once this returns, the owner's callback will no longer be called
+	 */
+	virtual void UnwatchImage(const void *owner) = 0;
+
+	/*! \brief Publish a CPU copy of a frame in the named image's shared memory frame ring, for consumers that can't
+	 * import textures. Rows of data are linesize bytes apart
+	 */
+	virtual bool WriteCpuFrame(const char *name, const uint8_t *data, uint32_t width, uint32_t height,
+	                           uint32_t linesize, gs_color_format format) = 0;
+
+	/*! \brief Remove the named image's frame ring
+	 */
+	virtual void RevokeCpuFrames(const char *name) = 0;
+
+	/*! \brief Map the newest CPU frame of the named image, unless its sequence equals after_sequence. Must be followed
+	 * by UnmapCpuFrame if successful
+	 */
+	virtual bool MapCpuFrame(const char *name, uint64_t after_sequence, TsvCpuFrame &frame) = 0;
+
+	/*! \brief Release a frame mapped by MapCpuFrame. Returns false if the sender overwrote the frame while it was
+	 * mapped, anything read from it is undefined in that case
+	 */
+	virtual bool UnmapCpuFrame(const char *name, const TsvCpuFrame &frame) = 0;
+
+	virtual void EnterGraphics() = 0;
+	virtual void LeaveGraphics() = 0;
+
+	virtual void AddMainRenderCallback(main_render_callback_t callback, void *param)    = 0;
+	virtual void RemoveMainRenderCallback(main_render_callback_t callback, void *param) = 0;
+
+	/*! \brief Number of the current OBS video frame, derived from the video clock
+	 */
+	virtual uint64_t GetVideoFrameIndex() = 0;
+
+	/*! \brief Frame rate of the OBS canvas
+	 */
+	virtual double GetVideoFrameRate() = 0;
+
+	/*! \brief Time (CLOCK_MONOTONIC, in ns) of the current OBS video frame
+	 */
+	virtual uint64_t GetVideoFrameTime() = 0;
+
+	virtual uint32_t GetSourceWidth(obs_source_t *source)  = 0;
+	virtual uint32_t GetSourceHeight(obs_source_t *source) = 0;
+
+	virtual void SkipVideoFilter(obs_source_t *filter) = 0;
+
+	/*! \brief Render source into the current width x height texrender. The source draws with its own effects, so only
+	 * the flip and premultiply_alpha conversions are applied, via projection and blend state
+	 */
+	virtual void RenderSource(obs_source_t *source, uint32_t width, uint32_t height,
+	                          const TsvConversion &conversion) = 0;
+
+	/*! \brief Render the filter's input into texrender via obs_source_process_filter_begin/end, using format for the
+	 * intermediate texture and applying conversion while drawing it. Returns false if the input could not be captured.
+	 * In that case the filter was either skipped or its unconverted input was drawn to the current render target
+	 */
+	virtual bool CaptureFilterInput(obs_source_t *filter, gs_texrender_t *texrender, uint32_t width, uint32_t height,
+	                                gs_color_format format, const TsvConversion &conversion) = 0;
+
+	/*! \brief Create texrender that will be rendered at width x height. Backends may hand out a previously destroyed
+	 * texrender of the same size and format
+	 */
+	virtual gs_texrender_t *CreateTexrender(uint32_t width, uint32_t height, gs_color_format format) = 0;
+	virtual void DestroyTexrender(gs_texrender_t *texrender)                                         = 0;
+
+	/*! \brief Reset texrender and begin rendering to it with a cleared, orthographic width x height canvas. Must be
+	 * followed by EndTexrender if successful
+	 */
+	virtual bool BeginTexrender(gs_texrender_t *texrender, uint32_t width, uint32_t height) = 0;
+	virtual void EndTexrender(gs_texrender_t *texrender)                                  = 0;
+
+	virtual gs_texture_t *GetTexrenderTexture(gs_texrender_t *texrender) = 0;
+
+	/*! \brief Create texture. Backends may hand out a previously destroyed texture of the same size and format, so its
+	 * content is undefined
+	 */
+	virtual gs_texture_t *CreateTexture(uint32_t width, uint32_t height, gs_color_format format) = 0;
+	virtual void DestroyTexture(gs_texture_t *texture)                                          = 0;
+
+	/*! \brief Create texture that can be updated with SetTextureImage. Not pooled, must be destroyed with
+	 * DestroyDynamicTexture
+	 */
+	virtual gs_texture_t *CreateDynamicTexture(uint32_t width, uint32_t height, gs_color_format format) = 0;
+	virtual void DestroyDynamicTexture(gs_texture_t *texture)                                          = 0;
+
+	/*! \brief Upload an image of the texture's size and format from CPU memory. Rows of data are linesize bytes apart
+	 */
+	virtual void SetTextureImage(gs_texture_t *texture, const uint8_t *data, uint32_t linesize) = 0;
+
+	/*! \brief Copy the content of texture into the equally sized dst texture on the GPU
+	 */
+	virtual void CopyTexture(gs_texture_t *dst, gs_texture_t *texture) = 0;
+
+	/*! \brief Draw texture, applying conversion. Drawn with the default OBS effect if there is nothing to convert
+	 */
+	virtual void DrawTexture(gs_texture_t *texture, const TsvConversion &conversion) = 0;
+
+	/*! \brief Render texture scaled down to width x height into texrender
+	 */
+	virtual bool DownscaleTexture(gs_texture_t *texture, gs_texrender_t *texrender, uint32_t width,
+	                              uint32_t height) = 0;
+
+	/*! \brief Render the width x height texture packed into the given pixel layout into texrender. The texrender is
+	 * rendered at the size returned by TsvPixelLayout::GetPackedSize
+	 */
+	virtual bool PackTexture(gs_texture_t *texture, gs_texrender_t *texrender, TsvPixelLayout::LAYOUT layout,
+	                         uint32_t width, uint32_t height) = 0;
+
+	/*! \brief Draw a texture packed into the given pixel layout as width x height RGBA image, applying conversion
+	 * while unpacking
+	 */
+	virtual void DrawPackedTexture(gs_texture_t *texture, TsvPixelLayout::LAYOUT layout, uint32_t width,
+	                               uint32_t height, const TsvConversion &conversion) = 0;
+
+	/*! \brief Compare texture with the equally sized previous texture in tiles of tile_size x tile_size pixels. Renders
+	 * one GS_R8 pixel per tile into texrender, non-zero if any pixel of the tile differs
+	 */
+	virtual bool CompareTiles(gs_texture_t *texture, gs_texture_t *previous, gs_texrender_t *texrender,
+	                          uint32_t tile_size) = 0;
+
+	/*! \brief Create surface for reading textures back to the CPU
+	 */
+	virtual gs_stagesurf_t *CreateStageSurface(uint32_t width, uint32_t height, gs_color_format format) = 0;
+	virtual void DestroyStageSurface(gs_stagesurf_t *stagesurf)                                        = 0;
+
+	/*! \brief Queue a copy of the equally sized texture into stagesurf. Does not wait for the copy
+	 */
+	virtual void StageTexture(gs_stagesurf_t *stagesurf, gs_texture_t *texture) = 0;
+
+	/*! \brief Map staged texture for reading. Waits for the copy if it didn't finish yet. Must be followed by
+	 * UnmapStageSurface if successful
+	 */
+	virtual bool MapStageSurface(gs_stagesurf_t *stagesurf, const uint8_t *&data, uint32_t &linesize) = 0;
+	virtual void UnmapStageSurface(gs_stagesurf_t *stagesurf)                                         = 0;
+
+	/*! \brief Insert a GPU fence after all previously submitted commands
+	 */
+	virtual fence_t CreateFence() = 0;
+
+	/*! \brief Check whether the GPU passed the fence. Does not block
+	 */
+	virtual bool IsFenceSignaled(fence_t fence) = 0;
+	virtual void DestroyFence(fence_t fence)    = 0;
+};
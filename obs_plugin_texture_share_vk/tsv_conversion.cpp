@@ -0,0 +1,29 @@
+#include "tsv_conversion.hpp"
+
+
+void TsvConversion::AddProperties(obs_properties_t *properties)
+{
+	obs_properties_add_bool(properties, PROPERTY_LINEAR_COLOR.data(), obs_module_text(PROPERTY_LINEAR_COLOR.data()));
+	obs_properties_add_bool(properties, PROPERTY_PREMULTIPLY_ALPHA.data(),
+	                        obs_module_text(PROPERTY_PREMULTIPLY_ALPHA.data()));
+	obs_properties_add_bool(properties, PROPERTY_FLIP_VERTICAL.data(), obs_module_text(PROPERTY_FLIP_VERTICAL.data()));
+	obs_properties_add_bool(properties, PROPERTY_SWIZZLE_BGRA.data(), obs_module_text(PROPERTY_SWIZZLE_BGRA.data()));
+}
+
+void TsvConversion::GetDefaults(obs_data_t *defaults)
+{
+	obs_data_set_default_bool(defaults, PROPERTY_LINEAR_COLOR.data(), false);
+	obs_data_set_default_bool(defaults, PROPERTY_PREMULTIPLY_ALPHA.data(), false);
+	obs_data_set_default_bool(defaults, PROPERTY_FLIP_VERTICAL.data(), false);
+	obs_data_set_default_bool(defaults, PROPERTY_SWIZZLE_BGRA.data(), false);
+}
+
+TsvConversion TsvConversion::FromSettings(obs_data_t *settings)
+{
+	TsvConversion conversion;
+	conversion.linear_color      = obs_data_get_bool(settings, PROPERTY_LINEAR_COLOR.data());
+	conversion.premultiply_alpha = obs_data_get_bool(settings, PROPERTY_PREMULTIPLY_ALPHA.data());
+	conversion.flip_vertical     = obs_data_get_bool(settings, PROPERTY_FLIP_VERTICAL.data());
+	conversion.swizzle_bgra      = obs_data_get_bool(settings, PROPERTY_SWIZZLE_BGRA.data());
+	return conversion;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <string_view>
+
+/*! \brief Color space, alpha, orientation and channel order conversions. Applied by data/tsv_pixel_layout.effect in a
+ * pass that draws the frame anyway, so none of them costs an extra pass. The sender applies them, a receiver with the
+ * same options undoes them
+ */
+struct TsvConversion
+{
+	static constexpr std::string_view PROPERTY_LINEAR_COLOR      = "linear_color";
+	static constexpr std::string_view PROPERTY_PREMULTIPLY_ALPHA = "premultiply_alpha";
+	static constexpr std::string_view PROPERTY_FLIP_VERTICAL     = "flip_vertical";
+	static constexpr std::string_view PROPERTY_SWIZZLE_BGRA      = "swizzle_bgra";
+
+	// Technique of data/tsv_pixel_layout.effect that draws an RGBA texture with conversions
+	static constexpr const char *TECHNIQUE = "Convert";
+
+	// Decode sRGB colors to linear ones
+	bool linear_color = false;
+
+	// Multiply colors with alpha. Applied after linear_color
+	bool premultiply_alpha = false;
+
+	// Mirror the image, so that its first row is the bottom one
+	bool flip_vertical = false;
+
+	// Swap red and blue
+	bool swizzle_bgra = false;
+
+	// Undo the conversions instead of applying them
+	bool inverse = false;
+
+	bool operator==(const TsvConversion &other) const = default;
+
+	/*! \brief Whether no conversion is enabled
+	 */
+	bool IsIdentity() const
+	{
+		return !this->linear_color && !this->premultiply_alpha && !this->flip_vertical && !this->swizzle_bgra;
+	}
+
+	/*! \brief Conversion that undoes this one
+	 */
+	TsvConversion Inverse() const
+	{
+		TsvConversion inverse = *this;
+		inverse.inverse       = !this->inverse;
+		return inverse;
+	}
+
+	/*! \brief Add a checkbox per conversion
+	 */
+	static void AddProperties(obs_properties_t *properties);
+
+	static void GetDefaults(obs_data_t *defaults);
+
+	static TsvConversion FromSettings(obs_data_t *settings);
+};
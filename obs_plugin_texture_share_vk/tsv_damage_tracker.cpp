@@ -0,0 +1,107 @@
+#include "tsv_damage_tracker.hpp"
+
+#include <algorithm>
+
+
+TsvDamageTracker::TsvDamageTracker(TsvBackend &backend)
+	: _backend(backend)
+{}
+
+TsvDamageTracker::~TsvDamageTracker()
+{
+	this->Clear();
+}
+
+void TsvDamageTracker::Resize(size_t slot_count, uint32_t width, uint32_t height)
+{
+	this->Clear();
+	this->_slots.resize(slot_count);
+
+	this->_width   = width;
+	this->_height  = height;
+	this->_tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	this->_tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+void TsvDamageTracker::Clear()
+{
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.tiles)
+			this->_backend.DestroyTexrender(slot.tiles);
+
+		if(slot.stagesurf)
+			this->_backend.DestroyStageSurface(slot.stagesurf);
+	}
+
+	this->_slots.clear();
+}
+
+void TsvDamageTracker::Detect(size_t slot_index, gs_texture_t *frame, gs_texture_t *previous)
+{
+	if(slot_index >= this->_slots.size())
+		return;
+
+	Slot &slot  = this->_slots[slot_index];
+	slot.staged = false;
+
+	if(!previous || this->_tiles_x == 0 || this->_tiles_y == 0)
+		return;
+
+	if(!slot.tiles)
+		slot.tiles = this->_backend.CreateTexrender(this->_tiles_x, this->_tiles_y, GS_R8);
+
+	if(!slot.stagesurf)
+		slot.stagesurf = this->_backend.CreateStageSurface(this->_tiles_x, this->_tiles_y, GS_R8);
+
+	if(!slot.stagesurf || !this->_backend.CompareTiles(frame, previous, slot.tiles, TILE_SIZE))
+		return;
+
+	this->_backend.StageTexture(slot.stagesurf, this->_backend.GetTexrenderTexture(slot.tiles));
+	slot.staged = true;
+}
+
+bool TsvDamageTracker::GetDamage(size_t slot_index, TsvImageRect &damage)
+{
+	damage = TsvImageRect{0, 0, this->_width, this->_height};
+
+	if(slot_index >= this->_slots.size() || !this->_slots[slot_index].staged)
+		return true;
+
+	Slot &slot  = this->_slots[slot_index];
+	slot.staged = false;
+
+	const uint8_t *data = nullptr;
+	uint32_t linesize   = 0;
+	if(!this->_backend.MapStageSurface(slot.stagesurf, data, linesize))
+		return true;
+
+	// Bounding rectangle of all changed tiles, in tiles
+	uint32_t min_x = this->_tiles_x, min_y = this->_tiles_y, max_x = 0, max_y = 0;
+	for(uint32_t y = 0; y < this->_tiles_y; ++y)
+	{
+		const uint8_t *const row = data + static_cast<size_t>(y) * linesize;
+		for(uint32_t x = 0; x < this->_tiles_x; ++x)
+		{
+			if(row[x] == 0)
+				continue;
+
+			min_x = std::min(min_x, x);
+			min_y = std::min(min_y, y);
+			max_x = std::max(max_x, x + 1);
+			max_y = std::max(max_y, y + 1);
+		}
+	}
+
+	this->_backend.UnmapStageSurface(slot.stagesurf);
+
+	if(max_x == 0)
+		return false;
+
+	damage.x      = min_x * TILE_SIZE;
+	damage.y      = min_y * TILE_SIZE;
+	damage.width  = std::min(max_x * TILE_SIZE, this->_width) - damage.x;
+	damage.height = std::min(max_y * TILE_SIZE, this->_height) - damage.y;
+
+	return true;
+}
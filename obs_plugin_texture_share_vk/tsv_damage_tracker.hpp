@@ -0,0 +1,60 @@
+#pragma once
+
+#include "tsv_backend.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Detects the region of a frame that changed relative to the previous frame. Both are compared tile by tile on
+ * the GPU and the per tile result is staged for reading back. One comparison is kept per TsvRenderRing slot and only
+ * read once the slot's frame is published, i.e. after its fence signaled, so reading it back doesn't wait for the GPU
+ */
+class TsvDamageTracker
+{
+	public:
+	// Edge length (in pixels) of the compared tiles. A multiple of TsvImageSync::DAMAGE_GRANULARITY
+	static constexpr uint32_t TILE_SIZE = 32;
+
+	explicit TsvDamageTracker(TsvBackend &backend);
+	~TsvDamageTracker();
+
+	TsvDamageTracker(const TsvDamageTracker &)            = delete;
+	TsvDamageTracker &operator=(const TsvDamageTracker &) = delete;
+
+	/*! \brief Drop all comparisons and change the number of slots and the frame size. Requires graphics context
+	 */
+	void Resize(size_t slot_count, uint32_t width, uint32_t height);
+
+	/*! \brief Destroy all tile render targets and stage surfaces. Requires graphics context
+	 */
+	void Clear();
+
+	/*! \brief Compare the frame rendered into slot with the previous frame. If previous is nullptr, the whole frame is
+	 * considered changed
+	 */
+	void Detect(size_t slot, gs_texture_t *frame, gs_texture_t *previous);
+
+	/*! \brief Get the bounding rectangle of the changed tiles of the frame in slot. Returns false if no tile changed.
+	 * Falls back to the whole frame if the slot's frame was not compared. Each comparison can only be read once
+	 */
+	bool GetDamage(size_t slot, TsvImageRect &damage);
+
+	private:
+	struct Slot
+	{
+		gs_texrender_t *tiles     = nullptr;
+		gs_stagesurf_t *stagesurf = nullptr;
+
+		// Whether the comparison was staged and not read yet
+		bool staged = false;
+	};
+
+	TsvBackend &_backend;
+
+	std::vector<Slot> _slots;
+
+	uint32_t _width   = 0;
+	uint32_t _height  = 0;
+	uint32_t _tiles_x = 0;
+	uint32_t _tiles_y = 0;
+};
@@ -0,0 +1,86 @@
+#include "tsv_frame_readback.hpp"
+
+
+TsvFrameReadback::TsvFrameReadback(TsvBackend &backend)
+	: _backend(backend)
+{}
+
+TsvFrameReadback::~TsvFrameReadback()
+{
+	this->Clear();
+}
+
+void TsvFrameReadback::Resize(size_t slot_count, uint32_t width, uint32_t height, gs_color_format format)
+{
+	this->Clear();
+	this->_slots.resize(slot_count);
+
+	this->_width  = width;
+	this->_height = height;
+	this->_format = format;
+}
+
+void TsvFrameReadback::Clear()
+{
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.stagesurf)
+			this->_backend.DestroyStageSurface(slot.stagesurf);
+	}
+
+	this->_slots.clear();
+}
+
+void TsvFrameReadback::Stage(size_t slot_index, gs_texture_t *frame)
+{
+	if(slot_index >= this->_slots.size())
+		return;
+
+	Slot &slot  = this->_slots[slot_index];
+	slot.staged = false;
+
+	if(!frame || this->_width == 0 || this->_height == 0)
+		return;
+
+	// Only allocated once frames are read back
+	if(!slot.stagesurf)
+		slot.stagesurf = this->_backend.CreateStageSurface(this->_width, this->_height, this->_format);
+
+	if(!slot.stagesurf)
+		return;
+
+	this->_backend.StageTexture(slot.stagesurf, frame);
+	slot.staged = true;
+}
+
+bool TsvFrameReadback::Map(size_t slot_index, const uint8_t *&data, uint32_t &linesize)
+{
+	if(slot_index >= this->_slots.size() || !this->_slots[slot_index].staged)
+		return false;
+
+	Slot &slot  = this->_slots[slot_index];
+	slot.staged = false;
+
+	return this->_backend.MapStageSurface(slot.stagesurf, data, linesize);
+}
+
+void TsvFrameReadback::Unmap(size_t slot_index)
+{
+	if(slot_index < this->_slots.size())
+		this->_backend.UnmapStageSurface(this->_slots[slot_index].stagesurf);
+}
+
+uint32_t TsvFrameReadback::GetWidth() const
+{
+	return this->_width;
+}
+
+uint32_t TsvFrameReadback::GetHeight() const
+{
+	return this->_height;
+}
+
+gs_color_format TsvFrameReadback::GetFormat() const
+{
+	return this->_format;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "tsv_backend.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Reads frames back to the CPU without waiting for the GPU. A copy of each frame is queued into a stage surface
+ * of its TsvRenderRing slot when the frame is submitted, and only mapped once the slot's frame is published, i.e.
+ * after its fence signaled. By then the copy finished as well, so mapping doesn't stall the render thread
+ */
+class TsvFrameReadback
+{
+	public:
+	explicit TsvFrameReadback(TsvBackend &backend);
+	~TsvFrameReadback();
+
+	TsvFrameReadback(const TsvFrameReadback &)            = delete;
+	TsvFrameReadback &operator=(const TsvFrameReadback &) = delete;
+
+	/*! \brief Drop all copies and change the number of slots and the frame size and format. Requires graphics context
+	 */
+	void Resize(size_t slot_count, uint32_t width, uint32_t height, gs_color_format format);
+
+	/*! \brief Destroy all stage surfaces. Requires graphics context
+	 */
+	void Clear();
+
+	/*! \brief Queue a copy of the frame rendered into slot. If frame is nullptr, only drops the slot's previous copy
+	 */
+	void Stage(size_t slot, gs_texture_t *frame);
+
+	/*! \brief Map the copy of the frame in slot. Returns false if the slot's frame was not staged. Each copy can only be
+	 * mapped once. Must be followed by Unmap if successful
+	 */
+	bool Map(size_t slot, const uint8_t *&data, uint32_t &linesize);
+	void Unmap(size_t slot);
+
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	gs_color_format GetFormat() const;
+
+	private:
+	struct Slot
+	{
+		gs_stagesurf_t *stagesurf = nullptr;
+
+		// Whether the copy was queued and not mapped yet
+		bool staged = false;
+	};
+
+	TsvBackend &_backend;
+
+	std::vector<Slot> _slots;
+
+	uint32_t _width         = 0;
+	uint32_t _height        = 0;
+	gs_color_format _format = GS_RGBA;
+};
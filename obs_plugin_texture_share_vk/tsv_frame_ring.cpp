@@ -0,0 +1,308 @@
+#include "tsv_frame_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstring>
+
+
+namespace
+{
+	size_t AlignUp(size_t size, size_t alignment)
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+} // namespace
+
+
+TsvFrameRing::TsvFrameRing(std::string image_name)
+	: _image_name(std::move(image_name))
+{}
+
+TsvFrameRing::~TsvFrameRing()
+{
+	this->Unmap();
+}
+
+bool TsvFrameRing::Write(const uint8_t *data, uint32_t width, uint32_t height, uint32_t linesize, FORMAT format)
+{
+	const uint32_t pixel_size = GetPixelSize(format);
+	if(!data || width == 0 || height == 0 || pixel_size == 0)
+		return false;
+
+	const size_t stride     = static_cast<size_t>(width) * pixel_size;
+	const size_t frame_size = stride * height;
+	if(linesize < stride)
+		return false;
+
+	if((!this->_data || !this->_is_producer || frame_size > this->GetRingHeader()->slot_size) &&
+	   !this->Create(frame_size))
+		return false;
+
+	RingHeader *const ring    = this->GetRingHeader();
+	const uint64_t sequence   = ++this->_sequence;
+	const uint32_t slot       = static_cast<uint32_t>(sequence % ring->slot_count);
+	FrameHeader *const header = this->GetFrameHeader(slot);
+
+	// Note: Readers that see the cleared sequence after reading the slot discard what they read
+	header->sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	header->timestamp_ns.store(MonotonicNs(), std::memory_order_relaxed);
+	header->width.store(width, std::memory_order_relaxed);
+	header->height.store(height, std::memory_order_relaxed);
+	header->stride.store(static_cast<uint32_t>(stride), std::memory_order_relaxed);
+	header->format.store(format, std::memory_order_relaxed);
+
+	uint8_t *const slot_data = this->_data + ring->data_offset + slot * ring->slot_size;
+	if(linesize == stride)
+		std::memcpy(slot_data, data, frame_size);
+	else
+	{
+		for(uint32_t y = 0; y < height; ++y)
+			std::memcpy(slot_data + y * stride, data + static_cast<size_t>(y) * linesize, stride);
+	}
+
+	header->sequence.store(sequence, std::memory_order_release);
+	ring->latest_sequence.store(sequence, std::memory_order_release);
+
+	return true;
+}
+
+void TsvFrameRing::Close()
+{
+	if(!this->_data || !this->_is_producer)
+		return;
+
+	this->GetRingHeader()->closed.store(1, std::memory_order_release);
+	shm_unlink(this->GetShmName().c_str());
+	this->Unmap();
+}
+
+bool TsvFrameRing::Read(uint64_t after_sequence, Frame &frame)
+{
+	if(!this->Open())
+		return false;
+
+	// Producer replaced the ring, e.g. after a resize or restart. Switch to the new one right away
+	if(this->GetRingHeader()->closed.load(std::memory_order_acquire))
+	{
+		this->Unmap();
+		this->_last_open_attempt = {};
+		if(!this->Open())
+			return false;
+	}
+
+	const RingHeader *const ring = this->GetRingHeader();
+	const uint64_t sequence      = ring->latest_sequence.load(std::memory_order_acquire);
+	if(sequence == 0 || sequence == after_sequence)
+		return false;
+
+	// Fails if the producer already started overwriting the slot
+	const uint32_t slot             = static_cast<uint32_t>(sequence % ring->slot_count);
+	const FrameHeader *const header = this->GetFrameHeader(slot);
+	if(header->sequence.load(std::memory_order_acquire) != sequence)
+		return false;
+
+	frame.width        = header->width.load(std::memory_order_relaxed);
+	frame.height       = header->height.load(std::memory_order_relaxed);
+	frame.stride       = header->stride.load(std::memory_order_relaxed);
+	frame.format       = static_cast<FORMAT>(header->format.load(std::memory_order_relaxed));
+	frame.timestamp_ns = header->timestamp_ns.load(std::memory_order_relaxed);
+	frame.sequence     = sequence;
+	frame.data         = this->_data + ring->data_offset + slot * ring->slot_size;
+
+	// Don't trust sizes read from another process
+	const uint32_t pixel_size = GetPixelSize(frame.format);
+	if(pixel_size == 0 || frame.stride < static_cast<uint64_t>(frame.width) * pixel_size ||
+	   static_cast<uint64_t>(frame.stride) * frame.height > ring->slot_size)
+		return false;
+
+	return this->IsIntact(frame);
+}
+
+bool TsvFrameRing::IsIntact(const Frame &frame) const
+{
+	if(!this->_data)
+		return false;
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	const RingHeader *const ring = this->GetRingHeader();
+	const uint32_t slot          = static_cast<uint32_t>(frame.sequence % ring->slot_count);
+	return this->GetFrameHeader(slot)->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
+
+uint32_t TsvFrameRing::GetPixelSize(FORMAT format)
+{
+	switch(format)
+	{
+		case FORMAT_RGBA8:
+		case FORMAT_BGRA8:
+			return 4;
+		case FORMAT_RGBA16F:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+bool TsvFrameRing::Create(size_t slot_size)
+{
+	const std::string shm_name = this->GetShmName();
+
+	if(this->_is_producer)
+		this->Close();
+	else
+	{
+		this->Unmap();
+
+		// Close a ring left behind by a previous producer, so that its readers switch to the new one
+		const int stale_fd = shm_open(shm_name.c_str(), O_RDWR, 0600);
+		if(stale_fd >= 0)
+		{
+			struct stat shm_stat;
+			if(fstat(stale_fd, &shm_stat) == 0 && static_cast<size_t>(shm_stat.st_size) >= sizeof(RingHeader))
+			{
+				void *const stale = mmap(nullptr, sizeof(RingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, stale_fd, 0);
+				if(stale != MAP_FAILED)
+				{
+					reinterpret_cast<RingHeader *>(stale)->closed.store(1, std::memory_order_release);
+					munmap(stale, sizeof(RingHeader));
+				}
+			}
+
+			close(stale_fd);
+		}
+
+		shm_unlink(shm_name.c_str());
+	}
+
+	slot_size                = AlignUp(slot_size, DATA_ALIGNMENT);
+	const size_t data_offset = AlignUp(sizeof(RingHeader) + SLOT_COUNT * sizeof(FrameHeader), DATA_ALIGNMENT);
+	const size_t data_size   = data_offset + SLOT_COUNT * slot_size;
+
+	const int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(fd < 0)
+		return false;
+
+	if(ftruncate(fd, static_cast<off_t>(data_size)) != 0)
+	{
+		close(fd);
+		shm_unlink(shm_name.c_str());
+		return false;
+	}
+
+	void *const data = mmap(nullptr, data_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(data == MAP_FAILED)
+	{
+		shm_unlink(shm_name.c_str());
+		return false;
+	}
+
+	this->_data        = reinterpret_cast<uint8_t *>(data);
+	this->_data_size   = data_size;
+	this->_is_producer = true;
+
+	// Zero-initialized by ftruncate, so all slots are empty
+	RingHeader *const ring = this->GetRingHeader();
+	ring->version          = VERSION;
+	ring->slot_count       = SLOT_COUNT;
+	ring->slot_size        = slot_size;
+	ring->data_offset      = data_offset;
+	ring->magic.store(MAGIC, std::memory_order_release);
+
+	return true;
+}
+
+bool TsvFrameRing::Open()
+{
+	if(this->_data)
+		return true;
+
+	// Only retry opening every OPEN_INTERVAL
+	const auto now = std::chrono::steady_clock::now();
+	if(now - this->_last_open_attempt < OPEN_INTERVAL)
+		return false;
+
+	this->_last_open_attempt = now;
+
+	const int fd = shm_open(this->GetShmName().c_str(), O_RDONLY, 0);
+	if(fd < 0)
+		return false;
+
+	struct stat shm_stat;
+	if(fstat(fd, &shm_stat) != 0 || static_cast<size_t>(shm_stat.st_size) < sizeof(RingHeader))
+	{
+		close(fd);
+		return false;
+	}
+
+	const size_t data_size = static_cast<size_t>(shm_stat.st_size);
+	void *const data       = mmap(nullptr, data_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(data == MAP_FAILED)
+		return false;
+
+	// Ignore rings that are still being created or that don't match their size
+	const RingHeader *const ring = reinterpret_cast<const RingHeader *>(data);
+	if(ring->magic.load(std::memory_order_acquire) != MAGIC || ring->version != VERSION || ring->slot_count == 0 ||
+	   ring->data_offset < sizeof(RingHeader) + ring->slot_count * sizeof(FrameHeader) ||
+	   ring->data_offset + ring->slot_count * ring->slot_size > data_size)
+	{
+		munmap(data, data_size);
+		return false;
+	}
+
+	this->_data        = reinterpret_cast<uint8_t *>(data);
+	this->_data_size   = data_size;
+	this->_is_producer = false;
+	return true;
+}
+
+void TsvFrameRing::Unmap()
+{
+	if(!this->_data)
+		return;
+
+	munmap(this->_data, this->_data_size);
+	this->_data      = nullptr;
+	this->_data_size = 0;
+}
+
+TsvFrameRing::RingHeader *TsvFrameRing::GetRingHeader() const
+{
+	return reinterpret_cast<RingHeader *>(this->_data);
+}
+
+TsvFrameRing::FrameHeader *TsvFrameRing::GetFrameHeader(uint32_t slot) const
+{
+	return reinterpret_cast<FrameHeader *>(this->_data + sizeof(RingHeader) + slot * sizeof(FrameHeader));
+}
+
+std::string TsvFrameRing::GetShmName() const
+{
+	// Shared memory names may not contain additional slashes
+	std::string shm_name = "/tsv_frames_" + this->_image_name;
+	for(size_t i = 1; i < shm_name.size(); ++i)
+	{
+		if(shm_name[i] == '/')
+			shm_name[i] = '_';
+	}
+
+	return shm_name;
+}
+
+uint64_t TsvFrameRing::MonotonicNs()
+{
+	// CLOCK_MONOTONIC is shared between processes
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*! \brief Ring of CPU frames in a POSIX shared memory object (/dev/shm/tsv_frames_<name>). Used by consumers that can't
+ * import GPU textures, e.g. processes without GPU access. They map the object read-only and read frames in place.
+ *
+ * Layout, all fields little endian:
+ * - RingHeader (64 bytes) at offset 0
+ * - slot_count FrameHeaders (64 bytes each) directly after it
+ * - slot_count frame buffers of slot_size bytes each, starting at data_offset. Both are multiples of DATA_ALIGNMENT
+ *
+ * The producer writes frame n into slot n % slot_count, rows tightly packed at stride bytes. Each FrameHeader acts as
+ * a sequence lock: its sequence is 0 while the slot is written and set to the frame's sequence afterwards. Readers
+ * compare the sequence before and after reading a frame to detect that it was overwritten. If the frames outgrow the
+ * ring, the producer marks it closed, unlinks it and creates a larger one under the same name
+ */
+class TsvFrameRing
+{
+	public:
+	// "TSVF". Stored last when the ring is created, readers ignore the ring until it is set
+	static constexpr uint32_t MAGIC   = 0x46565354;
+	static constexpr uint32_t VERSION = 1;
+
+	// Number of frame slots. A reader has slot_count - 1 frames time to read a frame before it is overwritten
+	static constexpr uint32_t SLOT_COUNT = 3;
+
+	// Time between attempts to open a not yet existing ring
+	static constexpr std::chrono::milliseconds OPEN_INTERVAL{250};
+
+	// Alignment (in bytes) of the frame buffers
+	static constexpr size_t DATA_ALIGNMENT = 4096;
+
+	enum FORMAT : uint32_t
+	{
+		FORMAT_UNKNOWN = 0,
+		// 8 bits per channel
+		FORMAT_RGBA8 = 1,
+		FORMAT_BGRA8 = 2,
+		// 16 bit float per channel
+		FORMAT_RGBA16F = 3,
+	};
+
+	/*! \brief Frame mapped from the ring. data stays mapped until the next Read() or Write() call
+	 */
+	struct Frame
+	{
+		const uint8_t *data   = nullptr;
+		uint32_t width        = 0;
+		uint32_t height       = 0;
+		uint32_t stride       = 0;
+		FORMAT format         = FORMAT_UNKNOWN;
+		uint64_t sequence     = 0;
+		uint64_t timestamp_ns = 0;
+	};
+
+	explicit TsvFrameRing(std::string image_name);
+	~TsvFrameRing();
+
+	TsvFrameRing(const TsvFrameRing &)            = delete;
+	TsvFrameRing &operator=(const TsvFrameRing &) = delete;
+
+	/*! \brief Copy a frame into the next slot and publish it. Rows of data are linesize bytes apart. (Re-)creates the
+	 * ring if it doesn't exist yet or is too small
+	 */
+	bool Write(const uint8_t *data, uint32_t width, uint32_t height, uint32_t linesize, FORMAT format);
+
+	/*! \brief Mark the ring closed and remove it. Mapped readers keep their mapping until they notice
+	 */
+	void Close();
+
+	/*! \brief Map the newest frame unless its sequence equals after_sequence, i.e. it was already read. Returns false
+	 * if there is no new frame. The frame may be overwritten while it is read, call IsIntact() afterwards
+	 */
+	bool Read(uint64_t after_sequence, Frame &frame);
+
+	/*! \brief Whether frame was not overwritten since Read() returned it
+	 */
+	bool IsIntact(const Frame &frame) const;
+
+	/*! \brief Bytes per pixel of format. 0 for FORMAT_UNKNOWN
+	 */
+	static uint32_t GetPixelSize(FORMAT format);
+
+	private:
+	struct RingHeader
+	{
+		std::atomic<uint32_t> magic;
+		uint32_t version;
+		uint32_t slot_count;
+		std::atomic<uint32_t> closed;
+		uint64_t slot_size;
+		uint64_t data_offset;
+		std::atomic<uint64_t> latest_sequence;
+		uint8_t reserved[24];
+	};
+
+	struct FrameHeader
+	{
+		// Sequence lock. 0 while the slot is written
+		std::atomic<uint64_t> sequence;
+		// CLOCK_MONOTONIC time at which the frame was written
+		std::atomic<uint64_t> timestamp_ns;
+		std::atomic<uint32_t> width;
+		std::atomic<uint32_t> height;
+		std::atomic<uint32_t> stride;
+		std::atomic<uint32_t> format;
+		uint8_t reserved[32];
+	};
+
+	static_assert(sizeof(RingHeader) == 64 && sizeof(FrameHeader) == 64, "Shared memory layout changed");
+
+	std::string _image_name;
+
+	uint8_t *_data     = nullptr;
+	size_t _data_size  = 0;
+	bool _is_producer  = false;
+	uint64_t _sequence = 0;
+
+	std::chrono::steady_clock::time_point _last_open_attempt;
+
+	/*! \brief Replace the ring by a new one with slots of at least slot_size bytes
+	 */
+	bool Create(size_t slot_size);
+
+	/*! \brief Map an existing ring read-only. Attempts are throttled to OPEN_INTERVAL
+	 */
+	bool Open();
+
+	void Unmap();
+
+	RingHeader *GetRingHeader() const;
+	FrameHeader *GetFrameHeader(uint32_t slot) const;
+
+	std::string GetShmName() const;
+
+	static uint64_t MonotonicNs();
+};
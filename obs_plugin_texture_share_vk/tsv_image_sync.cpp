@@ -0,0 +1,248 @@
+#include "tsv_image_sync.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+TsvImageSync::TsvImageSync(std::string image_name)
+	: _image_name(std::move(image_name))
+{}
+
+TsvImageSync::~TsvImageSync()
+{
+	this->Unmap();
+}
+
+const std::string &TsvImageSync::GetImageName() const
+{
+	return this->_image_name;
+}
+
+void TsvImageSync::AnnounceConsumer()
+{
+	// Note: Consumers never create the block. Nobody would remove it if the image is never sent
+	if(!this->Open(false))
+		return;
+
+	this->_data->last_beat_ns.store(MonotonicNs(), std::memory_order_relaxed);
+}
+
+bool TsvImageSync::HasConsumer(std::chrono::nanoseconds timeout)
+{
+	if(!this->Open(true))
+		return false;
+
+	const uint64_t last_beat = this->_data->last_beat_ns.load(std::memory_order_relaxed);
+	return last_beat != 0 && MonotonicNs() - last_beat <= static_cast<uint64_t>(timeout.count());
+}
+
+void TsvImageSync::PublishFrame(const TsvImageRect &damage, uint64_t timestamp_ns)
+{
+	if(!this->Open(true))
+		return;
+
+	// Note: Only the producer advances the generation. Store damage and timestamp first, consumers that see the new
+	// generation also see them
+	const uint64_t generation = this->_data->frame_generation.load(std::memory_order_relaxed) + 1;
+	this->_data->frame_damage.store(PackFrameDamage(generation, damage), std::memory_order_release);
+	this->_data->frame_timestamp.store(PackFrameTimestamp(generation, timestamp_ns), std::memory_order_release);
+	this->_data->frame_generation.store(generation, std::memory_order_release);
+}
+
+uint64_t TsvImageSync::GetFrameGeneration()
+{
+	if(!this->Open(false))
+		return UNKNOWN_GENERATION;
+
+	return this->_data->frame_generation.load(std::memory_order_acquire);
+}
+
+bool TsvImageSync::GetFrameDamage(uint64_t generation, TsvImageRect &damage)
+{
+	if(!this->Open(false))
+		return false;
+
+	const uint64_t frame_damage = this->_data->frame_damage.load(std::memory_order_acquire);
+	if(!(frame_damage & DAMAGE_VALID) || ((frame_damage >> 48) & 0x7FFF) != (generation & 0x7FFF))
+		return false;
+
+	damage.x      = static_cast<uint32_t>((frame_damage >> 36) & 0xFFF) * DAMAGE_GRANULARITY;
+	damage.y      = static_cast<uint32_t>((frame_damage >> 24) & 0xFFF) * DAMAGE_GRANULARITY;
+	damage.width  = static_cast<uint32_t>((frame_damage >> 12) & 0xFFF) * DAMAGE_GRANULARITY;
+	damage.height = static_cast<uint32_t>(frame_damage & 0xFFF) * DAMAGE_GRANULARITY;
+
+	return true;
+}
+
+uint64_t TsvImageSync::GetFrameTimestamp(uint64_t generation)
+{
+	if(!this->Open(false))
+		return UNKNOWN_TIMESTAMP;
+
+	const uint64_t frame_timestamp = this->_data->frame_timestamp.load(std::memory_order_acquire);
+	if(!(frame_timestamp & TIMESTAMP_VALID) || ((frame_timestamp >> 48) & 0x7FFF) != (generation & 0x7FFF))
+		return UNKNOWN_TIMESTAMP;
+
+	return (frame_timestamp & 0xFFFFFFFFFFFF) * 1000;
+}
+
+void TsvImageSync::PublishImageInfo(uint32_t width, uint32_t height, ImgFormat format, TsvPixelLayout::LAYOUT layout)
+{
+	if(!this->Open(true))
+		return;
+
+	this->_data->image_info.store(PackImageInfo(width, height, format, layout), std::memory_order_release);
+}
+
+void TsvImageSync::RevokeImageInfo()
+{
+	if(!this->_data)
+		return;
+
+	this->_data->image_info.store(0, std::memory_order_release);
+
+	// Note: Consumers still announce themselves on their mapping until they notice the block was closed. The next
+	// producer of the same name creates a new block
+	this->_data->closed.store(1, std::memory_order_release);
+	shm_unlink(this->GetShmName().c_str());
+	this->Unmap();
+}
+
+bool TsvImageSync::GetImageInfo(uint32_t &width, uint32_t &height, ImgFormat &format, TsvPixelLayout::LAYOUT &layout)
+{
+	if(!this->Open(false))
+		return false;
+
+	const uint64_t image_info = this->_data->image_info.load(std::memory_order_acquire);
+	if(!(image_info & IMAGE_AVAILABLE))
+		return false;
+
+	width  = static_cast<uint32_t>(image_info & 0xFFFF);
+	height = static_cast<uint32_t>((image_info >> 16) & 0xFFFF);
+	format = static_cast<ImgFormat>((image_info >> 32) & 0xFFFF);
+	layout = static_cast<TsvPixelLayout::LAYOUT>((image_info >> 48) & 0xFF);
+
+	return true;
+}
+
+void TsvImageSync::ResetOpenThrottle()
+{
+	this->_last_open_attempt = {};
+}
+
+bool TsvImageSync::Open(bool create)
+{
+	if(this->_data)
+	{
+		if(!this->_data->closed.load(std::memory_order_acquire))
+			return true;
+
+		// Producer removed the block. Switch to the one of the next producer right away
+		this->Unmap();
+		this->_last_open_attempt = {};
+	}
+
+	if(!create)
+	{
+		// Only retry opening every OPEN_INTERVAL
+		const auto now = std::chrono::steady_clock::now();
+		if(now - this->_last_open_attempt < OPEN_INTERVAL)
+			return false;
+
+		this->_last_open_attempt = now;
+	}
+
+	const std::string shm_name = this->GetShmName();
+
+	const int fd = shm_open(shm_name.c_str(), create ? (O_RDWR | O_CREAT) : O_RDWR, 0600);
+	if(fd < 0)
+		return false;
+
+	struct stat shm_stat;
+	if(fstat(fd, &shm_stat) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	if(static_cast<size_t>(shm_stat.st_size) < sizeof(SharedData) &&
+	   (!create || ftruncate(fd, sizeof(SharedData)) != 0))
+	{
+		close(fd);
+		return false;
+	}
+
+	void *const data = mmap(nullptr, sizeof(SharedData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(data == MAP_FAILED)
+		return false;
+
+	// Zero-initialized by ftruncate, which is a valid atomic state
+	this->_data = reinterpret_cast<SharedData *>(data);
+	return true;
+}
+
+void TsvImageSync::Unmap()
+{
+	if(!this->_data)
+		return;
+
+	munmap(this->_data, sizeof(SharedData));
+	this->_data = nullptr;
+}
+
+std::string TsvImageSync::GetShmName() const
+{
+	// Shared memory names may not contain additional slashes
+	std::string shm_name = "/tsv_image_" + this->_image_name;
+	for(size_t i = 1; i < shm_name.size(); ++i)
+	{
+		if(shm_name[i] == '/')
+			shm_name[i] = '_';
+	}
+
+	return shm_name;
+}
+
+uint64_t TsvImageSync::MonotonicNs()
+{
+	// CLOCK_MONOTONIC is shared between processes
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t TsvImageSync::PackImageInfo(uint32_t width, uint32_t height, ImgFormat format, TsvPixelLayout::LAYOUT layout)
+{
+	return IMAGE_AVAILABLE | (static_cast<uint64_t>(width) & 0xFFFF) | ((static_cast<uint64_t>(height) & 0xFFFF) << 16) |
+	       ((static_cast<uint64_t>(format) & 0xFFFF) << 32) | ((static_cast<uint64_t>(layout) & 0xFF) << 48);
+}
+
+uint64_t TsvImageSync::PackFrameDamage(uint64_t generation, const TsvImageRect &damage)
+{
+	// Extend region outwards to the granularity
+	const uint64_t x0 = damage.x / DAMAGE_GRANULARITY;
+	const uint64_t y0 = damage.y / DAMAGE_GRANULARITY;
+	const uint64_t x1 = (static_cast<uint64_t>(damage.x) + damage.width + DAMAGE_GRANULARITY - 1) / DAMAGE_GRANULARITY;
+	const uint64_t y1 = (static_cast<uint64_t>(damage.y) + damage.height + DAMAGE_GRANULARITY - 1) / DAMAGE_GRANULARITY;
+
+	// Regions beyond the representable range are not published, consumers copy the whole image
+	if(x1 > 0xFFF || y1 > 0xFFF)
+		return 0;
+
+	return DAMAGE_VALID | ((generation & 0x7FFF) << 48) | (x0 << 36) | (y0 << 24) | ((x1 - x0) << 12) | (y1 - y0);
+}
+
+uint64_t TsvImageSync::PackFrameTimestamp(uint64_t generation, uint64_t timestamp_ns)
+{
+	// 48 bits of microseconds cover almost 9 years of uptime
+	const uint64_t timestamp_us = timestamp_ns / 1000;
+	if(timestamp_us == 0 || timestamp_us > 0xFFFFFFFFFFFF)
+		return 0;
+
+	return TIMESTAMP_VALID | ((generation & 0x7FFF) << 48) | timestamp_us;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "tsv_pixel_layout.hpp"
+
+#include <texture_share_gl/texture_share_gl_client.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*! \brief Region of an image in pixels
+ */
+struct TsvImageRect
+{
+	uint32_t x      = 0;
+	uint32_t y      = 0;
+	uint32_t width  = 0;
+	uint32_t height = 0;
+
+	bool operator==(const TsvImageRect &other) const = default;
+};
+
+/*! \brief Per shared image synchronization block, stored in a small POSIX shared memory object next to the texture
+ * share server's image. Holds information the server does not track:
+ * - A consumer heartbeat. Consumers periodically call AnnounceConsumer(), producers call HasConsumer() to check whether
+ *   anyone read the image recently
+ * - A frame generation. Producers call PublishFrame() after each send, consumers only copy the image once
+ *   GetFrameGeneration() advanced. Each generation carries the region that changed relative to the previous one, so
+ *   consumers that hold the previous generation only need to copy that region. It also carries the CLOCK_MONOTONIC time
+ *   at which the frame was captured, so consumers can pace frames and measure latency
+ * - The image size, format and pixel layout. Producers call PublishImageInfo() after (re-)creating the image and RevokeImageInfo()
+ *   when they stop sending. Used by TsvImageWatcher to detect new, resized and removed images
+ *
+ * Only producers create blocks, consumers open existing ones. RevokeImageInfo() also marks the block closed and unlinks
+ * it, so no block outlives its image. Consumers that still map it switch to the next producer's block once they notice
+ *
+ * Once mapped, all calls are a single atomic access. Opening a not yet existing block is throttled to OPEN_INTERVAL
+ */
+class TsvImageSync
+{
+	public:
+	// Time between attempts to open a not yet existing synchronization block
+	static constexpr std::chrono::milliseconds OPEN_INTERVAL{250};
+
+	// Frame generation if the producer does not publish one
+	static constexpr uint64_t UNKNOWN_GENERATION = 0;
+
+	// Granularity (in pixels) of published damage regions. Regions are extended outwards to multiples of it
+	static constexpr uint32_t DAMAGE_GRANULARITY = 16;
+
+	// Frame timestamp if the producer does not publish one
+	static constexpr uint64_t UNKNOWN_TIMESTAMP = 0;
+
+	explicit TsvImageSync(std::string image_name);
+	~TsvImageSync();
+
+	TsvImageSync(const TsvImageSync &)            = delete;
+	TsvImageSync &operator=(const TsvImageSync &) = delete;
+
+	const std::string &GetImageName() const;
+
+	/*! \brief Mark image as consumed. Does nothing until a producer created the synchronization block
+	 */
+	void AnnounceConsumer();
+
+	/*! \brief Check whether a consumer called AnnounceConsumer() within the given timeout. Called by producers.
+	 * Creates the synchronization block if it doesn't exist yet, so that consumers can announce themselves before the
+	 * first frame
+	 */
+	bool HasConsumer(std::chrono::nanoseconds timeout);
+
+	/*! \brief Advance the frame generation. damage is the region of the image that changed relative to the previous
+	 * generation, timestamp_ns the CLOCK_MONOTONIC time at which the frame was captured. Creates the synchronization
+	 * block if it doesn't exist yet
+	 */
+	void PublishFrame(const TsvImageRect &damage, uint64_t timestamp_ns);
+
+	/*! \brief Get the current frame generation. Returns UNKNOWN_GENERATION if the producer never published one
+	 */
+	uint64_t GetFrameGeneration();
+
+	/*! \brief Get the region that changed between the previous and the given generation. Returns false if it is not
+	 * known, e.g. because the producer already published a newer generation. The region may exceed the image size
+	 */
+	bool GetFrameDamage(uint64_t generation, TsvImageRect &damage);
+
+	/*! \brief Get the capture time (CLOCK_MONOTONIC, in ns, with microsecond precision) of the given generation.
+	 * Returns UNKNOWN_TIMESTAMP if it is not known, e.g. because the producer already published a newer generation
+	 */
+	uint64_t GetFrameTimestamp(uint64_t generation);
+
+	/*! \brief Publish image size, format and pixel layout. For packed layouts, width and height are the size of the
+	 * unpacked image. Creates the synchronization block if it doesn't exist yet
+	 */
+	void PublishImageInfo(uint32_t width, uint32_t height, ImgFormat format, TsvPixelLayout::LAYOUT layout);
+
+	/*! \brief Mark image as no longer available, then close and remove the synchronization block
+	 */
+	void RevokeImageInfo();
+
+	/*! \brief Get published image size, format and pixel layout. Returns false if no producer currently publishes the
+	 * image
+	 */
+	bool GetImageInfo(uint32_t &width, uint32_t &height, ImgFormat &format, TsvPixelLayout::LAYOUT &layout);
+
+	/*! \brief Allow the next call to open the synchronization block immediately, e.g. after it was created
+	 */
+	void ResetOpenThrottle();
+
+	private:
+	struct SharedData
+	{
+		std::atomic<uint64_t> last_beat_ns;
+		std::atomic<uint64_t> frame_generation;
+
+		// Packed image info, see PackImageInfo(). Stored in a single atomic to always read a consistent state
+		std::atomic<uint64_t> image_info;
+
+		// Packed damage region of the latest generation, see PackFrameDamage()
+		std::atomic<uint64_t> frame_damage;
+
+		// Packed capture time of the latest generation, see PackFrameTimestamp()
+		std::atomic<uint64_t> frame_timestamp;
+
+		// Set once the producer removed the block
+		std::atomic<uint64_t> closed;
+	};
+
+	static constexpr uint64_t IMAGE_AVAILABLE = 1ull << 63;
+	static constexpr uint64_t DAMAGE_VALID    = 1ull << 63;
+	static constexpr uint64_t TIMESTAMP_VALID = 1ull << 63;
+
+	std::string _image_name;
+	SharedData *_data = nullptr;
+
+	std::chrono::steady_clock::time_point _last_open_attempt;
+
+	/*! \brief Map synchronization block. Replaces a mapped block that was closed. Without create, attempts are throttled
+	 * to OPEN_INTERVAL
+	 */
+	bool Open(bool create);
+
+	void Unmap();
+
+	std::string GetShmName() const;
+
+	static uint64_t MonotonicNs();
+
+	/*! \brief Pack image info as width: bits 0-15, height: bits 16-31, format: bits 32-47, layout: bits 48-55,
+	 * available: bit 63
+	 */
+	static uint64_t PackImageInfo(uint32_t width, uint32_t height, ImgFormat format, TsvPixelLayout::LAYOUT layout);
+
+	/*! \brief Pack damage region in units of DAMAGE_GRANULARITY as height: bits 0-11, width: bits 12-23, y: bits 24-35,
+	 * x: bits 36-47, the lower 15 bits of its generation: bits 48-62, valid: bit 63
+	 */
+	static uint64_t PackFrameDamage(uint64_t generation, const TsvImageRect &damage);
+
+	/*! \brief Pack capture time in microseconds: bits 0-47, the lower 15 bits of its generation: bits 48-62, valid:
+	 * bit 63
+	 */
+	static uint64_t PackFrameTimestamp(uint64_t generation, uint64_t timestamp_ns);
+};
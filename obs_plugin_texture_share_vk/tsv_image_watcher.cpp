@@ -0,0 +1,136 @@
+#include "tsv_image_watcher.hpp"
+
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+
+TsvImageWatcher &TsvImageWatcher::GetInstance()
+{
+	static TsvImageWatcher instance;
+	return instance;
+}
+
+TsvImageWatcher::~TsvImageWatcher()
+{
+	const auto lock = std::lock_guard(this->_thread_access);
+	this->Stop();
+}
+
+void TsvImageWatcher::Watch(const void *owner, const std::string &image_name, image_changed_callback_t callback)
+{
+	// Note: Held across changing the watches and starting or stopping the thread, so that a concurrent Unwatch() can't
+	// stop the thread after this watch was added
+	const auto thread_lock = std::lock_guard(this->_thread_access);
+	{
+		const auto lock = std::lock_guard(this->_access);
+
+		auto &watch      = this->_watches[owner];
+		watch.callback   = std::move(callback);
+		watch.image_sync = std::make_unique<TsvImageSync>(image_name);
+		watch.available  = false;
+	}
+
+	this->Start();
+}
+
+void TsvImageWatcher::Unwatch(const void *owner)
+{
+	const auto thread_lock = std::lock_guard(this->_thread_access);
+	bool empty;
+	{
+		const auto lock = std::lock_guard(this->_access);
+		this->_watches.erase(owner);
+		empty = this->_watches.empty();
+	}
+
+	if(empty)
+		this->Stop();
+}
+
+void TsvImageWatcher::Start()
+{
+	if(this->_running.exchange(true))
+		return;
+
+	if(this->_thread.joinable())
+		this->_thread.join();
+
+	this->_thread = std::thread(&TsvImageWatcher::Run, this);
+}
+
+void TsvImageWatcher::Stop()
+{
+	// Thread notices within WATCH_INTERVAL
+	this->_running = false;
+	if(this->_thread.joinable() && this->_thread.get_id() != std::this_thread::get_id())
+		this->_thread.join();
+}
+
+void TsvImageWatcher::Run()
+{
+	// Get notified when synchronization blocks are created or removed. Falls back to plain polling on failure
+	int notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(notify_fd >= 0 && inotify_add_watch(notify_fd, "/dev/shm", IN_CREATE | IN_DELETE) < 0)
+	{
+		close(notify_fd);
+		notify_fd = -1;
+	}
+
+	bool retry_open = true;
+	while(this->_running)
+	{
+		this->CheckWatches(retry_open);
+		retry_open = false;
+
+		pollfd poll_fd{notify_fd, POLLIN, 0};
+		if(poll(&poll_fd, notify_fd >= 0 ? 1 : 0, WATCH_INTERVAL.count()) <= 0)
+			continue;
+
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+		while((length = read(notify_fd, buffer, sizeof(buffer))) > 0)
+		{
+			for(ssize_t offset = 0; offset < length;)
+			{
+				const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+				if(event->len > 0 && std::strncmp(event->name, "tsv_image_", 10) == 0)
+					retry_open = true;
+
+				offset += sizeof(inotify_event) + event->len;
+			}
+		}
+	}
+
+	if(notify_fd >= 0)
+		close(notify_fd);
+}
+
+void TsvImageWatcher::CheckWatches(bool retry_open)
+{
+	const auto lock = std::lock_guard(this->_access);
+	for(auto &[owner, watch] : this->_watches)
+	{
+		if(retry_open)
+			watch.image_sync->ResetOpenThrottle();
+
+		uint32_t width                = 0;
+		uint32_t height               = 0;
+		ImgFormat format              = ImgFormat::R8G8B8A8;
+		TsvPixelLayout::LAYOUT layout = TsvPixelLayout::RGBA;
+
+		const bool available = watch.image_sync->GetImageInfo(width, height, format, layout);
+		if(available == watch.available && (!available || (width == watch.width && height == watch.height &&
+		                                                   format == watch.format && layout == watch.layout)))
+			continue;
+
+		watch.available = available;
+		watch.width     = width;
+		watch.height    = height;
+		watch.format    = format;
+		watch.layout    = layout;
+
+		watch.callback();
+	}
+}
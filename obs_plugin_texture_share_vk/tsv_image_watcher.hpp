@@ -0,0 +1,77 @@
+#pragma once
+
+#include "tsv_image_sync.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*! \brief Module wide background thread that watches the synchronization blocks of shared images and notifies
+ * interested receivers when an image is created, resized or removed. Replaces per source polling of the texture share
+ * server on the render thread.
+ *
+ * The thread wakes up when a synchronization block is created or removed in /dev/shm (inotify) and otherwise checks
+ * all watched images every WATCH_INTERVAL. Each check is a single atomic read per image
+ */
+class TsvImageWatcher
+{
+	public:
+	using image_changed_callback_t = std::function<void()>;
+
+	// Time between two checks of all watched images
+	static constexpr std::chrono::milliseconds WATCH_INTERVAL{50};
+
+	static TsvImageWatcher &GetInstance();
+
+	~TsvImageWatcher();
+
+	TsvImageWatcher(const TsvImageWatcher &)            = delete;
+	TsvImageWatcher &operator=(const TsvImageWatcher &) = delete;
+
+	/*! \brief Call callback whenever the named image changes. Replaces a previous watch of the same owner. The callback
+	 * is called from the watcher thread and should return quickly
+	 */
+	void Watch(const void *owner, const std::string &image_name, image_changed_callback_t callback);
+
+	/*! \brief Remove watch of owner. Once this returns, the owner's callback will no longer be called
+	 */
+	void Unwatch(const void *owner);
+
+	private:
+	struct ImageWatch
+	{
+		image_changed_callback_t callback;
+		std::unique_ptr<TsvImageSync> image_sync;
+
+		bool available                = false;
+		uint32_t width                = 0;
+		uint32_t height               = 0;
+		ImgFormat format              = ImgFormat::R8G8B8A8;
+		TsvPixelLayout::LAYOUT layout = TsvPixelLayout::RGBA;
+	};
+
+	std::mutex _access;
+	std::map<const void *, ImageWatch> _watches;
+
+	std::mutex _thread_access;
+	std::thread _thread;
+	std::atomic<bool> _running = false;
+
+	TsvImageWatcher() = default;
+
+	/*! \brief Start or stop the watcher thread. Require _thread_access
+	 */
+	void Start();
+	void Stop();
+
+	void Run();
+
+	/*! \brief Compare all watched images against their last known state and call callbacks of changed ones
+	 */
+	void CheckWatches(bool retry_open);
+};
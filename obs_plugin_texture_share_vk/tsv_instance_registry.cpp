@@ -0,0 +1,53 @@
+#include "tsv_instance_registry.hpp"
+
+
+TsvInstanceRegistry &TsvInstanceRegistry::GetInstance()
+{
+	static TsvInstanceRegistry instance;
+	return instance;
+}
+
+size_t TsvInstanceRegistry::Register(const void *owner, const std::string &name, ROLE role)
+{
+	const auto lock = std::lock_guard(this->_access);
+	this->_entries.erase(owner);
+
+	const size_t others = this->CountLocked(name, role);
+	this->_entries.emplace(owner, Entry{name, role});
+
+	return others;
+}
+
+size_t TsvInstanceRegistry::Add(const void *owner, const std::string &name, ROLE role)
+{
+	const auto lock = std::lock_guard(this->_access);
+
+	const size_t others = this->CountLocked(name, role);
+	this->_entries.emplace(owner, Entry{name, role});
+
+	return others;
+}
+
+void TsvInstanceRegistry::Unregister(const void *owner)
+{
+	const auto lock = std::lock_guard(this->_access);
+	this->_entries.erase(owner);
+}
+
+size_t TsvInstanceRegistry::GetCount(const std::string &name, ROLE role) const
+{
+	const auto lock = std::lock_guard(this->_access);
+	return this->CountLocked(name, role);
+}
+
+size_t TsvInstanceRegistry::CountLocked(const std::string &name, ROLE role) const
+{
+	size_t count = 0;
+	for(const auto &[owner, entry] : this->_entries)
+	{
+		if(entry.role == role && entry.name == name)
+			++count;
+	}
+
+	return count;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+/*! \brief Module wide registry of the images that are sent and received by the plugin instances of this process
+ */
+class TsvInstanceRegistry
+{
+	public:
+	enum ROLE
+	{
+		PUBLISHER,
+		CONSUMER
+	};
+
+	static TsvInstanceRegistry &GetInstance();
+
+	/*! \brief Register owner as publisher or consumer of the named image. Replaces all previous registrations of
+	 * owner. Returns the number of other instances registered with the same name and role
+	 */
+	size_t Register(const void *owner, const std::string &name, ROLE role);
+
+	/*! \brief Additionally register owner under another name, keeping its previous registrations. Returns the number of
+	 * other instances registered with the same name and role
+	 */
+	size_t Add(const void *owner, const std::string &name, ROLE role);
+
+	void Unregister(const void *owner);
+
+	/*! \brief Number of instances registered with the given name and role
+	 */
+	size_t GetCount(const std::string &name, ROLE role) const;
+
+	private:
+	struct Entry
+	{
+		std::string name;
+		ROLE role;
+	};
+
+	mutable std::mutex _access;
+	std::multimap<const void *, Entry> _entries;
+
+	TsvInstanceRegistry() = default;
+
+	size_t CountLocked(const std::string &name, ROLE role) const;
+};
@@ -0,0 +1,147 @@
+#include "tsv_jitter_buffer.hpp"
+
+
+TsvJitterBuffer::TsvJitterBuffer(TsvBackend &backend)
+	: _backend(backend)
+{}
+
+TsvJitterBuffer::~TsvJitterBuffer()
+{
+	this->Clear();
+}
+
+void TsvJitterBuffer::Resize(size_t capacity, uint32_t width, uint32_t height, gs_color_format format)
+{
+	this->Clear();
+	if(capacity > 0)
+		this->_slots.resize(capacity + 1);
+
+	this->_width  = width;
+	this->_height = height;
+	this->_format = format;
+}
+
+void TsvJitterBuffer::Clear()
+{
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.texture)
+			this->_backend.DestroyTexture(slot.texture);
+	}
+
+	this->_slots.clear();
+	this->_pushing = nullptr;
+}
+
+size_t TsvJitterBuffer::GetCapacity() const
+{
+	return this->_slots.empty() ? 0 : this->_slots.size() - 1;
+}
+
+bool TsvJitterBuffer::Push(gs_texture_t *texture, uint64_t timestamp_ns)
+{
+	bool dropped                     = false;
+	gs_texture_t *const slot_texture = this->BeginPush(dropped);
+	if(!slot_texture || !texture)
+		return false;
+
+	this->_backend.CopyTexture(slot_texture, texture);
+	this->EndPush(timestamp_ns);
+
+	return !dropped;
+}
+
+gs_texture_t *TsvJitterBuffer::BeginPush(bool &dropped)
+{
+	// Prefer free slots, then drop the oldest queued frame. The presented frame is kept, it is still drawn
+	Slot *free_slot     = nullptr;
+	Slot *oldest_queued = nullptr;
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.state == QUEUED)
+		{
+			if(!oldest_queued || slot.timestamp_ns < oldest_queued->timestamp_ns)
+				oldest_queued = &slot;
+		}
+		else if(slot.state == FREE && !free_slot)
+			free_slot = &slot;
+	}
+
+	Slot *const slot = free_slot ? free_slot : oldest_queued;
+	this->_pushing   = nullptr;
+	dropped          = false;
+	if(!slot)
+		return nullptr;
+
+	// Only allocated once frames are buffered
+	if(!slot->texture)
+		slot->texture = this->_backend.CreateTexture(this->_width, this->_height, this->_format);
+
+	if(!slot->texture)
+		return nullptr;
+
+	// Note: The slot's frame is overwritten, so it is dropped right away
+	dropped        = slot->state == QUEUED;
+	slot->state    = FREE;
+	this->_pushing = slot;
+
+	return slot->texture;
+}
+
+void TsvJitterBuffer::EndPush(uint64_t timestamp_ns)
+{
+	if(!this->_pushing)
+		return;
+
+	this->_pushing->timestamp_ns = timestamp_ns;
+	this->_pushing->state        = QUEUED;
+	this->_pushing               = nullptr;
+}
+
+TsvJitterBuffer::PresentedFrame TsvJitterBuffer::Present(uint64_t present_ns, uint64_t delay_ns)
+{
+	Slot *due       = nullptr;
+	Slot *presented = nullptr;
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.state == PRESENTED)
+			presented = &slot;
+		else if(slot.state == QUEUED &&
+		        (slot.timestamp_ns + delay_ns <= present_ns || slot.timestamp_ns > present_ns + MAX_AHEAD_NS) &&
+		        (!due || slot.timestamp_ns > due->timestamp_ns))
+			due = &slot;
+	}
+
+	PresentedFrame frame;
+	if(!due)
+	{
+		// Nothing due yet, keep drawing the previous frame
+		if(presented)
+		{
+			frame.texture      = presented->texture;
+			frame.timestamp_ns = presented->timestamp_ns;
+		}
+
+		return frame;
+	}
+
+	for(Slot &slot : this->_slots)
+	{
+		// Frames older than the due one are never drawn
+		if(slot.state == QUEUED && &slot != due && slot.timestamp_ns < due->timestamp_ns)
+		{
+			slot.state = FREE;
+			++frame.skipped;
+		}
+	}
+
+	if(presented)
+		presented->state = FREE;
+
+	due->state         = PRESENTED;
+	frame.texture      = due->texture;
+	frame.timestamp_ns = due->timestamp_ns;
+	frame.is_new       = true;
+
+	return frame;
+}
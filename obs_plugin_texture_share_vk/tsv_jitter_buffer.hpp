@@ -0,0 +1,98 @@
+#pragma once
+
+#include "tsv_backend.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Small queue of received frames, each copied into its own GPU texture. Frames are presented once their capture
+ * time plus a fixed delay passed, so arrival jitter doesn't turn into uneven frame durations. Never blocks: if the
+ * queue is full, the oldest queued frame is dropped
+ */
+class TsvJitterBuffer
+{
+	public:
+	// Frames stamped more than this ahead of the presentation time, e.g. by a sender that restarted with another clock,
+	// are presented right away instead of holding back all later frames
+	static constexpr uint64_t MAX_AHEAD_NS = 1000000000;
+
+	/*! \brief Frame selected by Present()
+	 */
+	struct PresentedFrame
+	{
+		// Texture to draw. nullptr if no frame was presented yet
+		gs_texture_t *texture = nullptr;
+		uint64_t timestamp_ns = 0;
+
+		// Whether the frame is drawn for the first time
+		bool is_new = false;
+
+		// Number of queued frames that were skipped because a newer one was due as well
+		uint64_t skipped = 0;
+	};
+
+	explicit TsvJitterBuffer(TsvBackend &backend);
+	~TsvJitterBuffer();
+
+	TsvJitterBuffer(const TsvJitterBuffer &)            = delete;
+	TsvJitterBuffer &operator=(const TsvJitterBuffer &) = delete;
+
+	/*! \brief Drop all frames and change the number of queued frames and the frame size and format. Requires graphics
+	 * context
+	 */
+	void Resize(size_t capacity, uint32_t width, uint32_t height, gs_color_format format);
+
+	/*! \brief Destroy all textures. Requires graphics context
+	 */
+	void Clear();
+
+	size_t GetCapacity() const;
+
+	/*! \brief Copy texture into the queue as frame captured at timestamp_ns. Returns false if the queue was full and
+	 * its oldest frame was dropped
+	 */
+	bool Push(gs_texture_t *texture, uint64_t timestamp_ns);
+
+	/*! \brief Get the texture the next frame is written to, so that it can be received straight into the queue.
+	 * dropped is set if the queue was full and its oldest frame was dropped for it. Must be followed by EndPush() once
+	 * the frame was written, otherwise the slot stays empty. Returns nullptr if the queue is not set up
+	 */
+	gs_texture_t *BeginPush(bool &dropped);
+
+	/*! \brief Queue the frame written to the texture returned by BeginPush() as captured at timestamp_ns
+	 */
+	void EndPush(uint64_t timestamp_ns);
+
+	/*! \brief Select the frame to draw at present_ns: the newest queued frame that was captured at least delay_ns
+	 * earlier. Older queued frames are skipped. Keeps the previously presented frame if no queued frame is due yet
+	 */
+	PresentedFrame Present(uint64_t present_ns, uint64_t delay_ns);
+
+	private:
+	enum SLOT_STATE
+	{
+		FREE,
+		QUEUED,
+		// Frame drawn by the last Present()
+		PRESENTED,
+	};
+
+	struct Slot
+	{
+		gs_texture_t *texture = nullptr;
+		uint64_t timestamp_ns = 0;
+		SLOT_STATE state      = FREE;
+	};
+
+	TsvBackend &_backend;
+
+	// One more slot than capacity, for the presented frame
+	std::vector<Slot> _slots;
+
+	// Slot returned by BeginPush(). nullptr if none
+	Slot *_pushing = nullptr;
+
+	uint32_t _width         = 0;
+	uint32_t _height        = 0;
+	gs_color_format _format = GS_RGBA;
+};
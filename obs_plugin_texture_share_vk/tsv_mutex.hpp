@@ -0,0 +1,93 @@
+#pragma once
+
+#include "tsv_trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/*! \brief std::mutex replacement that keeps track of how long it was held and how often it was contended. Satisfies
+ * Lockable, so it can be used with std::lock_guard
+ */
+class TsvMutex
+{
+	public:
+	void lock()
+	{
+		if(!this->_mutex.try_lock())
+		{
+			this->_contention_count.fetch_add(1, std::memory_order_relaxed);
+			const uint64_t wait_start_ns = TsvTrace::NowNs();
+			this->_mutex.lock();
+
+			// Note: The trace target is only changed while the mutex is held, so it can be read once locked
+			if(this->_trace_image)
+				TsvTrace::GetInstance().Record(this->_trace_category, "lock_wait", *this->_trace_image, wait_start_ns,
+				                               TsvTrace::NowNs());
+		}
+
+		this->_lock_start = std::chrono::steady_clock::now();
+	}
+
+	bool try_lock()
+	{
+		if(!this->_mutex.try_lock())
+			return false;
+
+		this->_lock_start = std::chrono::steady_clock::now();
+		return true;
+	}
+
+	void unlock()
+	{
+		const auto held = std::chrono::steady_clock::now() - this->_lock_start;
+		this->_hold_time_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(held).count(),
+		                              std::memory_order_relaxed);
+		this->_lock_count.fetch_add(1, std::memory_order_relaxed);
+
+		this->_mutex.unlock();
+	}
+
+	/*! \brief Accumulated time (in nanoseconds) the mutex was held
+	 */
+	uint64_t HoldTimeNs() const
+	{
+		return this->_hold_time_ns.load(std::memory_order_relaxed);
+	}
+
+	/*! \brief Number of times the mutex was locked
+	 */
+	uint64_t LockCount() const
+	{
+		return this->_lock_count.load(std::memory_order_relaxed);
+	}
+
+	/*! \brief Number of times lock() had to wait for another thread
+	 */
+	uint64_t ContentionCount() const
+	{
+		return this->_contention_count.load(std::memory_order_relaxed);
+	}
+
+	/*! \brief Record contended locks as trace events of image, or stop recording them if image is nullptr. image must
+	 * be guarded by this mutex. Must be called while holding the mutex
+	 */
+	void SetTraceImage(const char *category, const std::string *image)
+	{
+		this->_trace_category = category;
+		this->_trace_image    = image;
+	}
+
+	private:
+	std::mutex _mutex;
+	std::chrono::steady_clock::time_point _lock_start;
+
+	std::atomic<uint64_t> _hold_time_ns     = 0;
+	std::atomic<uint64_t> _lock_count       = 0;
+	std::atomic<uint64_t> _contention_count = 0;
+
+	const char *_trace_category     = nullptr;
+	const std::string *_trace_image = nullptr;
+};
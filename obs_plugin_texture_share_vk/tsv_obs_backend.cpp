@@ -0,0 +1,727 @@
+#include "tsv_obs_backend.hpp"
+
+#include "tsv_image_watcher.hpp"
+
+#include <obs.h>
+
+#include <cstdlib>
+#include <mutex>
+#include <set>
+
+
+TsvObsBackend::TsvObsBackend()
+	: _client(TsvSharedClient::Acquire()),
+	  _texture_pool(AcquireTexturePool())
+{}
+
+void TsvObsBackend::InitClient()
+{
+	this->_client->Connect();
+}
+
+bool TsvObsBackend::IsClientConnected()
+{
+	return this->_client->IsConnected();
+}
+
+bool TsvObsBackend::InitImage(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+                              bool overwrite_existing)
+{
+	const auto lock = this->_client->Lock();
+	this->_client->GetClient().init_image(name, width, height, format, overwrite_existing);
+	return true;
+}
+
+ImageLookupResult TsvObsBackend::FindImage(const char *name, bool force_update)
+{
+	const auto lock = this->_client->Lock();
+	return this->_client->GetClient().find_image(name, force_update);
+}
+
+bool TsvObsBackend::FindImageData(const char *name, bool force_update, TsvImageData &data)
+{
+	const auto lock      = this->_client->Lock();
+	const auto data_lock = this->_client->GetClient().find_image_data(name, force_update);
+	const auto *shmem    = data_lock.read();
+	if(shmem == nullptr)
+		return false;
+
+	data.width  = shmem->width;
+	data.height = shmem->height;
+	data.format = shmem->format;
+
+	return true;
+}
+
+bool TsvObsBackend::SendImage(const char *name, gs_texture_t *texture, const TsvImageRect &region)
+{
+	GLuint *const gl_texture = reinterpret_cast<GLuint *>(gs_texture_get_obj(texture));
+	if(!gl_texture)
+		return false;
+
+	// Copied region, same in texture and shared image
+	const GlImageExtent image_extent = GetImageExtent(region);
+
+	const auto lock       = this->_client->Lock();
+	const GLint drawFboId = this->_client->GetDrawFramebuffer();
+	this->_client->GetClient().send_image(name, *gl_texture, GL_TEXTURE_2D, false, drawFboId, &image_extent);
+	return true;
+}
+
+bool TsvObsBackend::RecvImage(const char *name, gs_texture_t *texture, const TsvImageRect &region, uint32_t dst_x,
+                              uint32_t dst_y)
+{
+	// The texture share client copies between the same region of both images. Move the region via a scratch texture
+	// that covers texture placed at the region's offset
+	if(dst_x != region.x || dst_y != region.y)
+	{
+		if(dst_x > region.x || dst_y > region.y)
+			return false;
+
+		// Note: Taken from and returned to the texture pool, so it is only allocated once per crop
+		const uint32_t scratch_width  = gs_texture_get_width(texture) + region.x - dst_x;
+		const uint32_t scratch_height = gs_texture_get_height(texture) + region.y - dst_y;
+		gs_texture_t *const scratch =
+			this->CreateTexture(scratch_width, scratch_height, gs_texture_get_color_format(texture));
+		const bool received = scratch && this->RecvImage(name, scratch, region, region.x, region.y);
+		if(received)
+			gs_copy_texture_region(texture, dst_x, dst_y, scratch, region.x, region.y, region.width, region.height);
+
+		this->DestroyTexture(scratch);
+		return received;
+	}
+
+	GLuint *const gl_texture = reinterpret_cast<GLuint *>(gs_texture_get_obj(texture));
+	if(!gl_texture)
+		return false;
+
+	const GlImageExtent image_extent = GetImageExtent(region);
+
+	const auto lock       = this->_client->Lock();
+	const GLint drawFboId = this->_client->GetDrawFramebuffer();
+	this->_client->GetClient().recv_image(name, *gl_texture, GL_TEXTURE_2D, false, drawFboId, &image_extent);
+	return true;
+}
+
+void TsvObsBackend::BeginSendBatch()
+{
+	this->_client->BeginBatch();
+}
+
+void TsvObsBackend::EndSendBatch()
+{
+	this->_client->EndBatch();
+}
+
+void TsvObsBackend::AnnounceConsumer(const char *name)
+{
+	this->GetImageSync(name).AnnounceConsumer();
+}
+
+bool TsvObsBackend::HasConsumer(const char *name, std::chrono::nanoseconds timeout)
+{
+	return this->GetImageSync(name).HasConsumer(timeout);
+}
+
+void TsvObsBackend::PublishFrame(const char *name, const TsvImageRect &damage, uint64_t timestamp_ns)
+{
+	this->GetImageSync(name).PublishFrame(damage, timestamp_ns);
+}
+
+uint64_t TsvObsBackend::GetFrameGeneration(const char *name)
+{
+	return this->GetImageSync(name).GetFrameGeneration();
+}
+
+bool TsvObsBackend::GetFrameDamage(const char *name, uint64_t generation, TsvImageRect &damage)
+{
+	return this->GetImageSync(name).GetFrameDamage(generation, damage);
+}
+
+uint64_t TsvObsBackend::GetFrameTimestamp(const char *name, uint64_t generation)
+{
+	return this->GetImageSync(name).GetFrameTimestamp(generation);
+}
+
+void TsvObsBackend::PublishImageInfo(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+                                     TsvPixelLayout::LAYOUT layout)
+{
+	this->GetImageSync(name).PublishImageInfo(width, height, format, layout);
+}
+
+bool TsvObsBackend::GetImageLayout(const char *name, TsvPixelLayout::LAYOUT &layout, uint32_t &width,
+                                   uint32_t &height)
+{
+	ImgFormat format;
+	return this->GetImageSync(name).GetImageInfo(width, height, format, layout);
+}
+
+void TsvObsBackend::RevokeImageInfo(const char *name)
+{
+	this->GetImageSync(name).RevokeImageInfo();
+}
+
+void TsvObsBackend::WatchImage(const void *owner, const char *name, image_changed_callback_t callback)
+{
+	TsvImageWatcher::GetInstance().Watch(owner, name, std::move(callback));
+}
+
+void TsvObsBackend::UnwatchImage(const void *owner)
+{
+	TsvImageWatcher::GetInstance().Unwatch(owner);
+}
+
+bool TsvObsBackend::WriteCpuFrame(const char *name, const uint8_t *data, uint32_t width, uint32_t height,
+                                  uint32_t linesize, gs_color_format format)
+{
+	return this->GetFrameRing(name).Write(data, width, height, linesize, GetFrameRingFormat(format));
+}
+
+void TsvObsBackend::RevokeCpuFrames(const char *name)
+{
+	this->GetFrameRing(name).Close();
+}
+
+bool TsvObsBackend::MapCpuFrame(const char *name, uint64_t after_sequence, TsvCpuFrame &frame)
+{
+	TsvFrameRing::Frame ring_frame;
+	if(!this->GetFrameRing(name).Read(after_sequence, ring_frame))
+		return false;
+
+	frame.data         = ring_frame.data;
+	frame.width        = ring_frame.width;
+	frame.height       = ring_frame.height;
+	frame.linesize     = ring_frame.stride;
+	frame.format       = GetColorFormat(ring_frame.format);
+	frame.sequence     = ring_frame.sequence;
+	frame.timestamp_ns = ring_frame.timestamp_ns;
+
+	return true;
+}
+
+bool TsvObsBackend::UnmapCpuFrame(const char *name, const TsvCpuFrame &frame)
+{
+	// Frames are read in place, only check that the sender didn't overwrite it meanwhile
+	TsvFrameRing::Frame ring_frame;
+	ring_frame.sequence = frame.sequence;
+	return this->GetFrameRing(name).IsIntact(ring_frame);
+}
+
+void TsvObsBackend::EnterGraphics()
+{
+	obs_enter_graphics();
+}
+
+void TsvObsBackend::LeaveGraphics()
+{
+	obs_leave_graphics();
+}
+
+void TsvObsBackend::AddMainRenderCallback(main_render_callback_t callback, void *param)
+{
+	obs_add_main_render_callback(callback, param);
+}
+
+void TsvObsBackend::RemoveMainRenderCallback(main_render_callback_t callback, void *param)
+{
+	obs_remove_main_render_callback(callback, param);
+}
+
+uint64_t TsvObsBackend::GetVideoFrameIndex()
+{
+	const uint64_t frame_interval = obs_get_frame_interval_ns();
+	return frame_interval > 0 ? obs_get_video_frame_time() / frame_interval : 0;
+}
+
+double TsvObsBackend::GetVideoFrameRate()
+{
+	const uint64_t frame_interval = obs_get_frame_interval_ns();
+	return frame_interval > 0 ? 1e9 / static_cast<double>(frame_interval) : 0.0;
+}
+
+uint64_t TsvObsBackend::GetVideoFrameTime()
+{
+	// Note: Based on os_gettime_ns(), i.e. CLOCK_MONOTONIC, which is shared between processes
+	return obs_get_video_frame_time();
+}
+
+uint32_t TsvObsBackend::GetSourceWidth(obs_source_t *source)
+{
+	return obs_source_get_base_width(source);
+}
+
+uint32_t TsvObsBackend::GetSourceHeight(obs_source_t *source)
+{
+	return obs_source_get_base_height(source);
+}
+
+void TsvObsBackend::SkipVideoFilter(obs_source_t *filter)
+{
+	obs_source_skip_video_filter(filter);
+}
+
+void TsvObsBackend::RenderSource(obs_source_t *source, uint32_t width, uint32_t height,
+                                 const TsvConversion &conversion)
+{
+	// Note: Undoing a conversion is never needed here, the sender only applies them
+	if(conversion.flip_vertical)
+		gs_ortho(0.0f, (float)width, (float)height, 0.0f, -100.0f, 100.0f);
+
+	// Blends straight alpha output onto the cleared texrender as premultiplied colors. Sources that set their own
+	// blend state, e.g. scenes, keep it
+	if(conversion.premultiply_alpha)
+		gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	obs_source_video_render(source);
+}
+
+bool TsvObsBackend::CaptureFilterInput(obs_source_t *filter, gs_texrender_t *texrender, uint32_t width,
+                                       uint32_t height, gs_color_format format, const TsvConversion &conversion)
+{
+	// Renders the filter input into the filter's own texrender. Skips the filter on failure
+	if(!obs_source_process_filter_begin(filter, format, OBS_NO_DIRECT_RENDERING))
+		return false;
+
+	gs_effect_t *const effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	if(!this->BeginTexrender(texrender, width, height))
+	{
+		// Pass input through without capturing it
+		obs_source_process_filter_end(filter, effect, width, height);
+		return false;
+	}
+
+	// Conversions are applied while drawing the input into texrender. The effect's image is set by OBS
+	gs_effect_t *convert_effect = nullptr;
+	if(!conversion.IsIdentity())
+		convert_effect = this->PreparePixelLayoutEffect(nullptr, TsvPixelLayout::RGBA, width, height, conversion);
+
+	if(convert_effect)
+		obs_source_process_filter_tech_end(filter, convert_effect, width, height, TsvConversion::TECHNIQUE);
+	else
+		obs_source_process_filter_end(filter, effect, width, height);
+
+	this->EndTexrender(texrender);
+
+	return true;
+}
+
+gs_texrender_t *TsvObsBackend::CreateTexrender(uint32_t width, uint32_t height, gs_color_format format)
+{
+	void *const pooled = this->_texture_pool->Take({TsvTexturePool::TEXRENDER, width, height, format});
+	if(pooled)
+		return reinterpret_cast<gs_texrender_t *>(pooled);
+
+	return gs_texrender_create(format, GS_ZS_NONE);
+}
+
+void TsvObsBackend::DestroyTexrender(gs_texrender_t *texrender)
+{
+	// Texrenders allocate their texture on first use, unused ones are not worth caching
+	gs_texture_t *const texture = gs_texrender_get_texture(texrender);
+	if(!texture)
+		return gs_texrender_destroy(texrender);
+
+	this->_texture_pool->Put({TsvTexturePool::TEXRENDER, gs_texture_get_width(texture), gs_texture_get_height(texture),
+	                          gs_texture_get_color_format(texture)},
+	                         texrender);
+}
+
+bool TsvObsBackend::BeginTexrender(gs_texrender_t *texrender, uint32_t width, uint32_t height)
+{
+	gs_texrender_reset(texrender);
+	if(!gs_texrender_begin(texrender, width, height))
+		return false;
+
+	// Transparent, so that premultiplied blending and sources that don't cover the canvas leave no tint
+	struct vec4 background;
+	vec4_zero(&background);
+
+	gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+	gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	return true;
+}
+
+void TsvObsBackend::EndTexrender(gs_texrender_t *texrender)
+{
+	gs_blend_state_pop();
+	gs_texrender_end(texrender);
+}
+
+gs_texture_t *TsvObsBackend::GetTexrenderTexture(gs_texrender_t *texrender)
+{
+	return gs_texrender_get_texture(texrender);
+}
+
+gs_texture_t *TsvObsBackend::CreateTexture(uint32_t width, uint32_t height, gs_color_format format)
+{
+	void *const pooled = this->_texture_pool->Take({TsvTexturePool::TEXTURE, width, height, format});
+	if(pooled)
+		return reinterpret_cast<gs_texture_t *>(pooled);
+
+	return gs_texture_create(width, height, format, 1, nullptr, 0);
+}
+
+void TsvObsBackend::DestroyTexture(gs_texture_t *texture)
+{
+	if(!texture)
+		return;
+
+	this->_texture_pool->Put({TsvTexturePool::TEXTURE, gs_texture_get_width(texture), gs_texture_get_height(texture),
+	                          gs_texture_get_color_format(texture)},
+	                         texture);
+}
+
+gs_texture_t *TsvObsBackend::CreateDynamicTexture(uint32_t width, uint32_t height, gs_color_format format)
+{
+	return gs_texture_create(width, height, format, 1, nullptr, GS_DYNAMIC);
+}
+
+void TsvObsBackend::DestroyDynamicTexture(gs_texture_t *texture)
+{
+	gs_texture_destroy(texture);
+}
+
+void TsvObsBackend::SetTextureImage(gs_texture_t *texture, const uint8_t *data, uint32_t linesize)
+{
+	// Note: Dynamic textures are uploaded through a pixel unpack buffer on OpenGL
+	gs_texture_set_image(texture, data, linesize, false);
+}
+
+void TsvObsBackend::CopyTexture(gs_texture_t *dst, gs_texture_t *texture)
+{
+	gs_copy_texture(dst, texture);
+}
+
+void TsvObsBackend::DrawTexture(gs_texture_t *texture, const TsvConversion &conversion)
+{
+	if(!conversion.IsIdentity())
+	{
+		gs_effect_t *const convert_effect = this->PreparePixelLayoutEffect(
+			texture, TsvPixelLayout::RGBA, gs_texture_get_width(texture), gs_texture_get_height(texture), conversion);
+		if(!convert_effect)
+			return;
+
+		while(gs_effect_loop(convert_effect, TsvConversion::TECHNIQUE))
+		{
+			gs_draw_sprite(texture, 0, 0, 0);
+		}
+
+		return;
+	}
+
+	// Get default obs effect for drawing
+	gs_effect_t *const effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	while(gs_effect_loop(effect, "Draw"))
+	{
+		obs_source_draw(texture, 0, 0, 0, 0, false);
+	}
+}
+
+bool TsvObsBackend::DownscaleTexture(gs_texture_t *texture, gs_texrender_t *texrender, uint32_t width,
+                                     uint32_t height)
+{
+	if(!this->BeginTexrender(texrender, width, height))
+		return false;
+
+	// Samples multiple texels per pixel, unlike the default effect's single bilinear tap
+	gs_effect_t *const effect = obs_get_base_effect(OBS_EFFECT_BILINEAR_LOWRES);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+	while(gs_effect_loop(effect, "Draw"))
+	{
+		gs_draw_sprite(texture, 0, width, height);
+	}
+
+	this->EndTexrender(texrender);
+
+	return true;
+}
+
+bool TsvObsBackend::PackTexture(gs_texture_t *texture, gs_texrender_t *texrender, TsvPixelLayout::LAYOUT layout,
+                                uint32_t width, uint32_t height)
+{
+	const char *const technique = TsvPixelLayout::GetPackTechnique(layout);
+	gs_effect_t *const effect   = this->PreparePixelLayoutEffect(texture, layout, width, height);
+	if(!technique || !effect)
+		return false;
+
+	uint32_t packed_width, packed_height;
+	TsvPixelLayout::GetPackedSize(layout, width, height, packed_width, packed_height);
+	if(!this->BeginTexrender(texrender, packed_width, packed_height))
+		return false;
+
+	while(gs_effect_loop(effect, technique))
+	{
+		gs_draw_sprite(nullptr, 0, packed_width, packed_height);
+	}
+
+	this->EndTexrender(texrender);
+
+	return true;
+}
+
+void TsvObsBackend::DrawPackedTexture(gs_texture_t *texture, TsvPixelLayout::LAYOUT layout, uint32_t width,
+                                      uint32_t height, const TsvConversion &conversion)
+{
+	const char *const technique = TsvPixelLayout::GetUnpackTechnique(layout);
+	if(!technique)
+		return this->DrawTexture(texture, conversion);
+
+	gs_effect_t *const effect = this->PreparePixelLayoutEffect(texture, layout, width, height, conversion);
+	if(!effect)
+		return;
+
+	while(gs_effect_loop(effect, technique))
+	{
+		gs_draw_sprite(nullptr, 0, width, height);
+	}
+}
+
+bool TsvObsBackend::CompareTiles(gs_texture_t *texture, gs_texture_t *previous, gs_texrender_t *texrender,
+                                 uint32_t tile_size)
+{
+	if(!this->_damage_effect)
+		this->_damage_effect = AcquireEffect("tsv_damage.effect");
+
+	gs_effect_t *const effect = this->_damage_effect.get();
+	if(!effect || tile_size == 0)
+		return false;
+
+	const uint32_t width   = gs_texture_get_width(texture);
+	const uint32_t height  = gs_texture_get_height(texture);
+	const uint32_t tiles_x = (width + tile_size - 1) / tile_size;
+	const uint32_t tiles_y = (height + tile_size - 1) / tile_size;
+	if(!this->BeginTexrender(texrender, tiles_x, tiles_y))
+		return false;
+
+	struct vec2 image_size, tile_count;
+	vec2_set(&image_size, (float)width, (float)height);
+	vec2_set(&tile_count, (float)tiles_x, (float)tiles_y);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "previous"), previous);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "image_size"), &image_size);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "tile_count"), &tile_count);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "tile_size"), (float)tile_size);
+
+	while(gs_effect_loop(effect, "CompareTiles"))
+	{
+		gs_draw_sprite(nullptr, 0, tiles_x, tiles_y);
+	}
+
+	this->EndTexrender(texrender);
+
+	return true;
+}
+
+gs_stagesurf_t *TsvObsBackend::CreateStageSurface(uint32_t width, uint32_t height, gs_color_format format)
+{
+	return gs_stagesurface_create(width, height, format);
+}
+
+void TsvObsBackend::DestroyStageSurface(gs_stagesurf_t *stagesurf)
+{
+	gs_stagesurface_destroy(stagesurf);
+}
+
+void TsvObsBackend::StageTexture(gs_stagesurf_t *stagesurf, gs_texture_t *texture)
+{
+	gs_stage_texture(stagesurf, texture);
+}
+
+bool TsvObsBackend::MapStageSurface(gs_stagesurf_t *stagesurf, const uint8_t *&data, uint32_t &linesize)
+{
+	uint8_t *mapped_data = nullptr;
+	if(!gs_stagesurface_map(stagesurf, &mapped_data, &linesize))
+		return false;
+
+	data = mapped_data;
+	return true;
+}
+
+void TsvObsBackend::UnmapStageSurface(gs_stagesurf_t *stagesurf)
+{
+	gs_stagesurface_unmap(stagesurf);
+}
+
+TsvBackend::fence_t TsvObsBackend::CreateFence()
+{
+	return reinterpret_cast<fence_t>(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+bool TsvObsBackend::IsFenceSignaled(fence_t fence)
+{
+	// Zero timeout, only flushes pending commands so that the fence eventually signals
+	const GLenum res = glClientWaitSync(reinterpret_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+	// Treat failures as signaled, otherwise the frame would never be published
+	return res != GL_TIMEOUT_EXPIRED;
+}
+
+void TsvObsBackend::DestroyFence(fence_t fence)
+{
+	glDeleteSync(reinterpret_cast<GLsync>(fence));
+}
+
+TsvImageSync &TsvObsBackend::GetImageSync(const char *name)
+{
+	auto image_sync_it = this->_image_syncs.find(std::string_view(name));
+	if(image_sync_it == this->_image_syncs.end())
+		image_sync_it = this->_image_syncs.emplace(name, std::make_unique<TsvImageSync>(name)).first;
+
+	return *image_sync_it->second;
+}
+
+TsvFrameRing &TsvObsBackend::GetFrameRing(const char *name)
+{
+	auto frame_ring_it = this->_frame_rings.find(std::string_view(name));
+	if(frame_ring_it == this->_frame_rings.end())
+		frame_ring_it = this->_frame_rings.emplace(name, std::make_unique<TsvFrameRing>(name)).first;
+
+	return *frame_ring_it->second;
+}
+
+std::shared_ptr<TsvTexturePool> TsvObsBackend::AcquireTexturePool()
+{
+	static std::mutex instance_access;
+	static std::weak_ptr<TsvTexturePool> instance;
+
+	const auto lock = std::lock_guard(instance_access);
+
+	auto texture_pool = instance.lock();
+	if(!texture_pool)
+	{
+		uint64_t memory_limit = TsvTexturePool::DEFAULT_MEMORY_LIMIT;
+		if(const char *limit_mb = std::getenv("TSV_TEXTURE_POOL_LIMIT_MB"))
+			memory_limit = std::strtoull(limit_mb, nullptr, 10) * 1024 * 1024;
+
+		// Note: Also called when the last backend is destroyed, so enter graphics here
+		const auto destroy = [](TsvTexturePool::RESOURCE_TYPE type, void *resource) {
+			obs_enter_graphics();
+
+			if(type == TsvTexturePool::TEXRENDER)
+				gs_texrender_destroy(reinterpret_cast<gs_texrender_t *>(resource));
+			else
+				gs_texture_destroy(reinterpret_cast<gs_texture_t *>(resource));
+
+			obs_leave_graphics();
+		};
+
+		texture_pool = std::make_shared<TsvTexturePool>(destroy, memory_limit);
+		instance     = texture_pool;
+	}
+
+	return texture_pool;
+}
+
+gs_effect_t *TsvObsBackend::PreparePixelLayoutEffect(gs_texture_t *texture, TsvPixelLayout::LAYOUT layout,
+                                                     uint32_t width, uint32_t height, const TsvConversion &conversion)
+{
+	if(!this->_pixel_layout_effect)
+		this->_pixel_layout_effect = AcquireEffect("tsv_pixel_layout.effect");
+
+	gs_effect_t *const effect = this->_pixel_layout_effect.get();
+	if(!effect)
+		return nullptr;
+
+	uint32_t plane_width, plane_height, packed_width, packed_height;
+	TsvPixelLayout::GetPlaneSize(layout, width, height, plane_width, plane_height);
+	TsvPixelLayout::GetPackedSize(layout, width, height, packed_width, packed_height);
+
+	struct vec2 image_size, plane_size, packed_size;
+	vec2_set(&image_size, (float)width, (float)height);
+	vec2_set(&plane_size, (float)plane_width, (float)plane_height);
+	vec2_set(&packed_size, (float)packed_width, (float)packed_height);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "image_size"), &image_size);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "plane_size"), &plane_size);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "packed_size"), &packed_size);
+
+	// Note: The effect is shared, parameters of a previous draw's conversion must not leak into this one
+	const float direction = conversion.inverse ? -1.0f : 1.0f;
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "linearize"), conversion.linear_color ? direction : 0.0f);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "premultiply"),
+	                    conversion.premultiply_alpha ? direction : 0.0f);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "flip"), conversion.flip_vertical ? 1.0f : 0.0f);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "swizzle"), conversion.swizzle_bgra ? 1.0f : 0.0f);
+
+	return effect;
+}
+
+std::shared_ptr<gs_effect_t> TsvObsBackend::AcquireEffect(const char *file_name)
+{
+	static std::mutex instance_access;
+	static std::map<std::string, std::weak_ptr<gs_effect_t>, std::less<>> instances;
+	static std::set<std::string, std::less<>> load_failed;
+
+	const auto lock = std::lock_guard(instance_access);
+
+	std::weak_ptr<gs_effect_t> &instance = instances[file_name];
+
+	auto effect = instance.lock();
+	if(!effect && load_failed.count(file_name) == 0)
+	{
+		char *const effect_path          = obs_module_file(file_name);
+		gs_effect_t *const loaded_effect = effect_path ? gs_effect_create_from_file(effect_path, nullptr) : nullptr;
+		bfree(effect_path);
+
+		if(!loaded_effect)
+		{
+			blog(LOG_ERROR, "Failed to load %s. Features using it are unavailable", file_name);
+			load_failed.emplace(file_name);
+			return nullptr;
+		}
+
+		// Note: Also called when the last backend is destroyed, so enter graphics here
+		effect = std::shared_ptr<gs_effect_t>(loaded_effect, [](gs_effect_t *effect) {
+			obs_enter_graphics();
+			gs_effect_destroy(effect);
+			obs_leave_graphics();
+		});
+		instance = effect;
+	}
+
+	return effect;
+}
+
+GlImageExtent TsvObsBackend::GetImageExtent(const TsvImageRect &region)
+{
+	return GlImageExtent{
+		{(GLsizei)region.x,                  (GLsizei)region.y                  },
+		{(GLsizei)(region.x + region.width), (GLsizei)(region.y + region.height)},
+	};
+}
+
+TsvFrameRing::FORMAT TsvObsBackend::GetFrameRingFormat(gs_color_format format)
+{
+	switch(format)
+	{
+		case GS_RGBA:
+			return TsvFrameRing::FORMAT_RGBA8;
+		case GS_BGRA:
+			return TsvFrameRing::FORMAT_BGRA8;
+		case GS_RGBA16F:
+			return TsvFrameRing::FORMAT_RGBA16F;
+		default:
+			return TsvFrameRing::FORMAT_UNKNOWN;
+	}
+}
+
+gs_color_format TsvObsBackend::GetColorFormat(TsvFrameRing::FORMAT format)
+{
+	switch(format)
+	{
+		case TsvFrameRing::FORMAT_RGBA8:
+			return GS_RGBA;
+		case TsvFrameRing::FORMAT_BGRA8:
+			return GS_BGRA;
+		case TsvFrameRing::FORMAT_RGBA16F:
+			return GS_RGBA16F;
+		default:
+			return GS_UNKNOWN;
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "tsv_backend.hpp"
+#include "tsv_frame_ring.hpp"
+#include "tsv_image_sync.hpp"
+#include "tsv_shared_client.hpp"
+#include "tsv_texture_pool.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+
+/*! \brief Backend forwarding to the module's shared TextureShareGlClient and libobs
+ */
+class TsvObsBackend : public TsvBackend
+{
+	public:
+	TsvObsBackend();
+	~TsvObsBackend() override = default;
+
+	void InitClient() override;
+	bool IsClientConnected() override;
+	bool InitImage(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+	               bool overwrite_existing) override;
+	ImageLookupResult FindImage(const char *name, bool force_update) override;
+	bool FindImageData(const char *name, bool force_update, TsvImageData &data) override;
+	bool SendImage(const char *name, gs_texture_t *texture, const TsvImageRect &region) override;
+	bool RecvImage(const char *name, gs_texture_t *texture, const TsvImageRect &region, uint32_t dst_x,
+	               uint32_t dst_y) override;
+	void BeginSendBatch() override;
+	void EndSendBatch() override;
+
+	void AnnounceConsumer(const char *name) override;
+	bool HasConsumer(const char *name, std::chrono::nanoseconds timeout) override;
+	void PublishFrame(const char *name, const TsvImageRect &damage, uint64_t timestamp_ns) override;
+	uint64_t GetFrameGeneration(const char *name) override;
+	bool GetFrameDamage(const char *name, uint64_t generation, TsvImageRect &damage) override;
+	uint64_t GetFrameTimestamp(const char *name, uint64_t generation) override;
+	void PublishImageInfo(const char *name, uint32_t width, uint32_t height, ImgFormat format,
+	                      TsvPixelLayout::LAYOUT layout) override;
+	bool GetImageLayout(const char *name, TsvPixelLayout::LAYOUT &layout, uint32_t &width, uint32_t &height) override;
+	void RevokeImageInfo(const char *name) override;
+	void WatchImage(const void *owner, const char *name, image_changed_callback_t callback) override;
+	void UnwatchImage(const void *owner) override;
+
+	bool WriteCpuFrame(const char *name, const uint8_t *data, uint32_t width, uint32_t height, uint32_t linesize,
+	                   gs_color_format format) override;
+	void RevokeCpuFrames(const char *name) override;
+	bool MapCpuFrame(const char *name, uint64_t after_sequence, TsvCpuFrame &frame) override;
+	bool UnmapCpuFrame(const char *name, const TsvCpuFrame &frame) override;
+
+	void EnterGraphics() override;
+	void LeaveGraphics() override;
+
+	void AddMainRenderCallback(main_render_callback_t callback, void *param) override;
+	void RemoveMainRenderCallback(main_render_callback_t callback, void *param) override;
+
+	uint64_t GetVideoFrameIndex() override;
+	double GetVideoFrameRate() override;
+	uint64_t GetVideoFrameTime() override;
+
+	uint32_t GetSourceWidth(obs_source_t *source) override;
+	uint32_t GetSourceHeight(obs_source_t *source) override;
+
+	void SkipVideoFilter(obs_source_t *filter) override;
+	void RenderSource(obs_source_t *source, uint32_t width, uint32_t height, const TsvConversion &conversion) override;
+	bool CaptureFilterInput(obs_source_t *filter, gs_texrender_t *texrender, uint32_t width, uint32_t height,
+	                        gs_color_format format, const TsvConversion &conversion) override;
+
+	gs_texrender_t *CreateTexrender(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyTexrender(gs_texrender_t *texrender) override;
+	bool BeginTexrender(gs_texrender_t *texrender, uint32_t width, uint32_t height) override;
+	void EndTexrender(gs_texrender_t *texrender) override;
+	gs_texture_t *GetTexrenderTexture(gs_texrender_t *texrender) override;
+
+	gs_texture_t *CreateTexture(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyTexture(gs_texture_t *texture) override;
+
+	gs_texture_t *CreateDynamicTexture(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyDynamicTexture(gs_texture_t *texture) override;
+	void SetTextureImage(gs_texture_t *texture, const uint8_t *data, uint32_t linesize) override;
+
+	void CopyTexture(gs_texture_t *dst, gs_texture_t *texture) override;
+	void DrawTexture(gs_texture_t *texture, const TsvConversion &conversion) override;
+	bool DownscaleTexture(gs_texture_t *texture, gs_texrender_t *texrender, uint32_t width, uint32_t height) override;
+	bool PackTexture(gs_texture_t *texture, gs_texrender_t *texrender, TsvPixelLayout::LAYOUT layout, uint32_t width,
+	                 uint32_t height) override;
+	void DrawPackedTexture(gs_texture_t *texture, TsvPixelLayout::LAYOUT layout, uint32_t width, uint32_t height,
+	                       const TsvConversion &conversion) override;
+
+	bool CompareTiles(gs_texture_t *texture, gs_texture_t *previous, gs_texrender_t *texrender,
+	                  uint32_t tile_size) override;
+
+	gs_stagesurf_t *CreateStageSurface(uint32_t width, uint32_t height, gs_color_format format) override;
+	void DestroyStageSurface(gs_stagesurf_t *stagesurf) override;
+	void StageTexture(gs_stagesurf_t *stagesurf, gs_texture_t *texture) override;
+	bool MapStageSurface(gs_stagesurf_t *stagesurf, const uint8_t *&data, uint32_t &linesize) override;
+	void UnmapStageSurface(gs_stagesurf_t *stagesurf) override;
+
+	fence_t CreateFence() override;
+	bool IsFenceSignaled(fence_t fence) override;
+	void DestroyFence(fence_t fence) override;
+
+	private:
+	std::shared_ptr<TsvSharedClient> _client;
+
+	// Module wide pool of destroyed textures and texrenders
+	std::shared_ptr<TsvTexturePool> _texture_pool;
+
+	// Module wide effects. Loaded on first use
+	std::shared_ptr<gs_effect_t> _pixel_layout_effect;
+	std::shared_ptr<gs_effect_t> _damage_effect;
+
+	std::map<std::string, std::unique_ptr<TsvImageSync>, std::less<>> _image_syncs;
+	std::map<std::string, std::unique_ptr<TsvFrameRing>, std::less<>> _frame_rings;
+
+	/*! \brief Get synchronization block of the named image. Opened on first use
+	 */
+	TsvImageSync &GetImageSync(const char *name);
+
+	/*! \brief Get CPU frame ring of the named image. Opened on first use
+	 */
+	TsvFrameRing &GetFrameRing(const char *name);
+
+	/*! \brief Get the module's texture pool. Created on first use, its memory limit can be set in MiB via the
+	 * TSV_TEXTURE_POOL_LIMIT_MB environment variable.
+	 *
+	 * Note: The send filter and the receive source are separate shared libraries, each with its own copy of this
+	 * function. Each module has its own pool, and the limit applies to each of them. Sharing one pool would tie the
+	 * other module's resources to the lifetime of the module that created it
+	 */
+	static std::shared_ptr<TsvTexturePool> AcquireTexturePool();
+
+	/*! \brief Get the pixel layout effect with parameters set for drawing texture with conversion. Returns nullptr if
+	 * the effect could not be loaded. Requires graphics context
+	 */
+	gs_effect_t *PreparePixelLayoutEffect(gs_texture_t *texture, TsvPixelLayout::LAYOUT layout, uint32_t width,
+	                                      uint32_t height, const TsvConversion &conversion = {});
+
+	/*! \brief Get the module's instance of the named effect. Loaded from the module's data directory on first use, only
+	 * one attempt is made per effect. Requires graphics context
+	 */
+	static std::shared_ptr<gs_effect_t> AcquireEffect(const char *file_name);
+
+	/*! \brief Convert region to the extent passed to the texture share client
+	 */
+	static GlImageExtent GetImageExtent(const TsvImageRect &region);
+
+	/*! \brief Convert between OBS color formats and frame ring formats. Unsupported formats are mapped to
+	 * TsvFrameRing::FORMAT_UNKNOWN and GS_UNKNOWN
+	 */
+	static TsvFrameRing::FORMAT GetFrameRingFormat(gs_color_format format);
+	static gs_color_format GetColorFormat(TsvFrameRing::FORMAT format);
+};
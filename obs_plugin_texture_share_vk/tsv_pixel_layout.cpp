@@ -0,0 +1,81 @@
+#include "tsv_pixel_layout.hpp"
+
+
+namespace
+{
+	uint32_t AlignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+} // namespace
+
+void TsvPixelLayout::GetPlaneSize(LAYOUT layout, uint32_t width, uint32_t height, uint32_t &plane_width,
+                                  uint32_t &plane_height)
+{
+	switch(layout)
+	{
+		case NV12:
+			plane_width  = AlignUp(width, 4);
+			plane_height = AlignUp(height, 2);
+			break;
+		case I420:
+			plane_width  = AlignUp(width, 8);
+			plane_height = AlignUp(height, 4);
+			break;
+		default:
+			plane_width  = width;
+			plane_height = height;
+			break;
+	}
+}
+
+void TsvPixelLayout::GetPackedSize(LAYOUT layout, uint32_t width, uint32_t height, uint32_t &packed_width,
+                                   uint32_t &packed_height)
+{
+	uint32_t plane_width, plane_height;
+	GetPlaneSize(layout, width, height, plane_width, plane_height);
+
+	switch(layout)
+	{
+		case NV12:
+		case I420:
+			// Y plane plus half sized chroma planes at 1 byte per sample
+			packed_width  = plane_width / 4;
+			packed_height = plane_height + plane_height / 2;
+			break;
+		default:
+			packed_width  = plane_width;
+			packed_height = plane_height;
+			break;
+	}
+}
+
+const char *TsvPixelLayout::GetPackTechnique(LAYOUT layout)
+{
+	switch(layout)
+	{
+		case NV12:
+			return "PackNV12";
+		case I420:
+			return "PackI420";
+		case R10G10B10A2:
+			return "PackR10G10B10A2";
+		default:
+			return nullptr;
+	}
+}
+
+const char *TsvPixelLayout::GetUnpackTechnique(LAYOUT layout)
+{
+	switch(layout)
+	{
+		case NV12:
+			return "UnpackNV12";
+		case I420:
+			return "UnpackI420";
+		case R10G10B10A2:
+			return "UnpackR10G10B10A2";
+		default:
+			return nullptr;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+/*! \brief Arrangement of pixel data inside a shared R8G8B8A8 image. The texture share server only supports 8-bit
+ * RGBA/BGRA images, so compact and high bit depth formats are packed into RGBA texels by a shader on the sending side
+ * and unpacked while drawing on the receiving side. The layout is published via TsvImageSync
+ */
+class TsvPixelLayout
+{
+	public:
+	enum LAYOUT
+	{
+		// One pixel per texel
+		RGBA,
+		// BT.709 limited range Y plane followed by an interleaved half resolution UV plane, 4 bytes per texel
+		NV12,
+		// BT.709 limited range Y plane followed by half resolution U and V planes, 4 bytes per texel. Each texel row of
+		// the chroma planes holds two chroma rows
+		I420,
+		// One 10-bit per channel pixel per texel. Bits 0-9: R, 10-19: G, 20-29: B, 30-31: A
+		R10G10B10A2,
+	};
+
+	static constexpr LAYOUT MAX_LAYOUT = R10G10B10A2;
+
+	/*! \brief Size of the plane(s) an image of the given size is padded to. YUV layouts require a width divisible by
+	 * 4 (NV12) or 8 (I420) and an even (NV12) or by 4 divisible (I420) height
+	 */
+	static void GetPlaneSize(LAYOUT layout, uint32_t width, uint32_t height, uint32_t &plane_width,
+	                         uint32_t &plane_height);
+
+	/*! \brief Size of the shared R8G8B8A8 image holding an image of the given size
+	 */
+	static void GetPackedSize(LAYOUT layout, uint32_t width, uint32_t height, uint32_t &packed_width,
+	                          uint32_t &packed_height);
+
+	/*! \brief Technique of data/tsv_pixel_layout.effect that converts an RGBA texture to the given layout. Returns
+	 * nullptr for RGBA, which needs no conversion
+	 */
+	static const char *GetPackTechnique(LAYOUT layout);
+
+	/*! \brief Technique of data/tsv_pixel_layout.effect that draws a packed texture as RGBA. Returns nullptr for RGBA
+	 */
+	static const char *GetUnpackTechnique(LAYOUT layout);
+};
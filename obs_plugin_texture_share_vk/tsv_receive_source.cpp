@@ -1,291 +1,694 @@
 #include "tsv_receive_source.hpp"
 
+#include "tsv_instance_registry.hpp"
+#include "tsv_trace.hpp"
+
 #include <obs.h>
-#include <texture_share_gl/texture_share_gl_client.h>
-#include <util/bmem.h>
-// #include <obs/graphics/graphics.h>
+
+#include <algorithm>
+#include <utility>
 
 
-extern "C"
+TsvReceiveSource::TsvReceiveSource(obs_data_t *settings, obs_source_t *source, std::unique_ptr<TsvBackend> backend)
+	: _backend(std::move(backend)),
+	  _source(source),
+	  _jitter_buffer(*this->_backend)
 {
-	/* Required OBS module commands (required) */
-	OBS_DECLARE_MODULE();
-	OBS_MODULE_USE_DEFAULT_LOCALE(OBSPluginTextureShareSource::PLUGIN_NAME.data(), "en-US");
-
-	// Define plugin info
-	const char *obs_get_name(void *type_data);
-	void *obs_create(obs_data_t *settings, obs_source_t *source);
-	void obs_destroy(void *data);
-	uint32_t obs_get_width(void *data);
-	uint32_t obs_get_height(void *data);
-	void obs_get_defaults(void *data, obs_data_t *defaults);
-	obs_properties_t *obs_get_properties(void *data);
-	void obs_update(void *data, obs_data_t *settings);
-	void obs_video_tick(void *data, float seconds);
-	void obs_video_render(void *data, gs_effect_t *effect);
-
-	constexpr struct obs_source_info obs_plugin_texture_share_info = {
-		.id             = TsvReceiveSource::PLUGIN_NAME.data(),
-		.type           = OBS_SOURCE_TYPE_INPUT,
-		.output_flags   = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW,
-		.get_name       = obs_get_name,
-		.create         = obs_create,
-		.destroy        = obs_destroy,
-		.get_width      = obs_get_width,
-		.get_height     = obs_get_height,
-		.get_properties = obs_get_properties,
-		.update         = obs_update,
-		.video_tick     = obs_video_tick,
-		.video_render   = obs_video_render,
-		.get_defaults2  = obs_get_defaults,
-	};
+	// Report last known size until the shared image was found
+	this->_image_width  = static_cast<uint32_t>(obs_data_get_int(settings, PROPERTY_LAST_WIDTH.data()));
+	this->_image_height = static_cast<uint32_t>(obs_data_get_int(settings, PROPERTY_LAST_HEIGHT.data()));
+	this->_tex_format   = static_cast<gs_color_format>(obs_data_get_int(settings, PROPERTY_LAST_FORMAT.data()));
+	this->StoreImageInfo();
 
-	// Load module
-	bool obs_module_load(void)
+	this->UpdateProperties(settings);
+	this->_published_settings.Adopt(this->_settings);
+
+	this->_backend->AddMainRenderCallback(&TsvReceiveSource::PrefetchCb, this);
+
+	if(this->_source)
 	{
-		obs_register_source(&obs_plugin_texture_share_info);
-		return true;
+		proc_handler_t *const proc_handler = obs_source_get_proc_handler(this->_source);
+		proc_handler_add(proc_handler, TsvStats::PROC_GET_STATS.data(), &TsvReceiveSource::GetStatsCb, this);
+		proc_handler_add(proc_handler, TsvTrace::PROC_GET_TRACE.data(), &TsvTrace::GetTraceCb, this);
 	}
 
-	const char *obs_get_name(void *type_data)
+	this->_backend->InitClient();
+}
+
+TsvReceiveSource::~TsvReceiveSource()
+{
+	this->_backend->UnwatchImage(this);
+	TsvInstanceRegistry::GetInstance().Unregister(this);
+
+	// Note: The render thread holds the graphics context while rendering, entering it waits for the current frame
+	this->_backend->EnterGraphics();
+
+	this->_backend->RemoveMainRenderCallback(&TsvReceiveSource::PrefetchCb, this);
+
+	this->DestroyTexture();
+
+	this->_source = nullptr;
+
+	this->_backend->LeaveGraphics();
+}
+
+uint32_t TsvReceiveSource::GetWidth()
+{
+	// Note: Called by OBS from any thread, while the render thread may resize the image
+	return this->_last_width.load(std::memory_order_relaxed);
+}
+
+uint32_t TsvReceiveSource::GetHeight()
+{
+	return this->_last_height.load(std::memory_order_relaxed);
+}
+
+obs_properties_t *TsvReceiveSource::GetProperties()
+{
+	obs_properties_t *properties = obs_properties_create();
+
+	obs_properties_add_text(properties, PROPERTY_SHARED_TEXTURE_NAME.data(),
+	                        obs_module_text(PROPERTY_SHARED_TEXTURE_NAME.data()), OBS_TEXT_DEFAULT);
+
+	obs_property_t *transport =
+		obs_properties_add_list(properties, PROPERTY_TRANSPORT.data(), obs_module_text(PROPERTY_TRANSPORT.data()),
+	                            OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(transport, obs_module_text(PROPERTY_TRANSPORT_GPU.data()), TRANSPORT_GPU);
+	obs_property_list_add_int(transport, obs_module_text(PROPERTY_TRANSPORT_SHARED_MEMORY.data()),
+	                          TRANSPORT_SHARED_MEMORY);
+
+	obs_properties_add_int(properties, PROPERTY_JITTER_BUFFER.data(), obs_module_text(PROPERTY_JITTER_BUFFER.data()),
+	                       0, MAX_JITTER_BUFFER, 1);
+
+	for(const std::string_view property : {PROPERTY_CROP_LEFT, PROPERTY_CROP_TOP, PROPERTY_CROP_RIGHT,
+	                                       PROPERTY_CROP_BOTTOM})
+		obs_properties_add_int(properties, property.data(), obs_module_text(property.data()), 0, MAX_CROP, 1);
+
+	TsvConversion::AddProperties(properties);
+	TsvTrace::AddProperties(properties);
+	this->_stats.AddProperties(properties, this->_access);
+
+	return properties;
+}
+
+void TsvReceiveSource::GetDefaults(obs_data_t *defaults)
+{
+	obs_data_set_default_string(defaults, PROPERTY_SHARED_TEXTURE_NAME.data(),
+	                            obs_module_text(PROPERTY_SHARED_TEXTURE_NAME_DEFAULT.data()));
+	obs_data_set_default_int(defaults, PROPERTY_TRANSPORT.data(), TRANSPORT_GPU);
+	obs_data_set_default_int(defaults, PROPERTY_JITTER_BUFFER.data(), 0);
+	obs_data_set_default_int(defaults, PROPERTY_CROP_LEFT.data(), 0);
+	obs_data_set_default_int(defaults, PROPERTY_CROP_TOP.data(), 0);
+	obs_data_set_default_int(defaults, PROPERTY_CROP_RIGHT.data(), 0);
+	obs_data_set_default_int(defaults, PROPERTY_CROP_BOTTOM.data(), 0);
+	obs_data_set_default_bool(defaults, TsvTrace::PROPERTY_TRACE.data(), false);
+	TsvConversion::GetDefaults(defaults);
+}
+
+void TsvReceiveSource::UpdateProperties(obs_data_t *settings)
+{
+	const char *new_sender_name   = obs_data_get_string(settings, PROPERTY_SHARED_TEXTURE_NAME.data());
+	const long long transport     = obs_data_get_int(settings, PROPERTY_TRANSPORT.data());
+	const TRANSPORT new_transport = transport == TRANSPORT_SHARED_MEMORY ? TRANSPORT_SHARED_MEMORY : TRANSPORT_GPU;
+	const long long jitter_buffer = obs_data_get_int(settings, PROPERTY_JITTER_BUFFER.data());
+	const uint32_t new_jitter_buffer =
+		static_cast<uint32_t>(std::clamp<long long>(jitter_buffer, 0, MAX_JITTER_BUFFER));
+
+	const auto get_crop = [settings](std::string_view property) {
+		return static_cast<uint32_t>(std::clamp<long long>(obs_data_get_int(settings, property.data()), 0, MAX_CROP));
+	};
+	const Crop new_crop{get_crop(PROPERTY_CROP_LEFT), get_crop(PROPERTY_CROP_TOP), get_crop(PROPERTY_CROP_RIGHT),
+	                    get_crop(PROPERTY_CROP_BOTTOM)};
+	const bool new_trace               = obs_data_get_bool(settings, TsvTrace::PROPERTY_TRACE.data());
+	const TsvConversion new_conversion = TsvConversion::FromSettings(settings);
+	if(new_trace)
+		TsvTrace::GetInstance().Reserve();
+
+	const auto lock            = std::lock_guard(this->_access);
+	Settings &written_settings = this->_written_settings;
+	const bool renamed         = written_settings.shared_texture_name != new_sender_name;
+	if(!renamed && written_settings.transport == new_transport && written_settings.jitter_buffer == new_jitter_buffer &&
+	   written_settings.crop == new_crop && written_settings.trace == new_trace &&
+	   written_settings.conversion == new_conversion)
+		return;
+
+	// The render thread releases the texture of the previous image once it adopts the new settings
+	written_settings.shared_texture_name = new_sender_name;
+	written_settings.transport           = new_transport;
+	written_settings.jitter_buffer       = new_jitter_buffer;
+	written_settings.crop                = new_crop;
+	written_settings.trace               = new_trace;
+	written_settings.conversion          = new_conversion;
+	this->_published_settings.Publish(written_settings);
+
+	this->_access.SetTraceImage(PLUGIN_NAME.data(), new_trace ? &written_settings.shared_texture_name : nullptr);
+
+	if(!renamed)
+		return;
+
+	// Get notified when the image is created, resized or removed
+	const std::string &name = this->_written_settings.shared_texture_name;
+	if(name.empty())
 	{
-		UNUSED_PARAMETER(type_data);
-		return TsvReceiveSource::PLUGIN_NAME.data();
+		this->_backend->UnwatchImage(this);
+		TsvInstanceRegistry::GetInstance().Unregister(this);
 	}
-
-	void *obs_create(obs_data_t *settings, obs_source_t *source)
+	else
 	{
-		// Enter graphics to load OpenGL functions
-		obs_enter_graphics();
+		this->_backend->WatchImage(this, name.c_str(), [this]() { this->_image_changed = true; });
+		TsvInstanceRegistry::GetInstance().Register(this, name, TsvInstanceRegistry::CONSUMER);
+	}
+}
 
-		TextureShareGlClient::initialize_gl_external();
-		void *data = bmalloc(sizeof(TsvReceiveSource));
-		new(data) TsvReceiveSource(settings, source);
+void TsvReceiveSource::SaveSettings(obs_data_t *settings)
+{
+	obs_data_set_int(settings, PROPERTY_LAST_WIDTH.data(), this->_last_width.load(std::memory_order_relaxed));
+	obs_data_set_int(settings, PROPERTY_LAST_HEIGHT.data(), this->_last_height.load(std::memory_order_relaxed));
+	obs_data_set_int(settings, PROPERTY_LAST_FORMAT.data(), this->_last_format.load(std::memory_order_relaxed));
+}
 
-		obs_leave_graphics();
-		return data;
-	}
+void TsvReceiveSource::OnTick(float seconds)
+{
+	// Note: Called on the render thread, outside of the graphics context
+	this->_published_settings.Adopt(this->_settings);
+
+	// Notify senders that the image is being read. Hidden sources and sources of unused scenes are not drawn and must
+	// not keep lazy senders busy
+	const std::string &name    = this->_settings->shared_texture_name;
+	const uint64_t frame_index = this->_backend->GetVideoFrameIndex();
+	if(!name.empty() && this->_drawn_frame != NO_FRAME && frame_index <= this->_drawn_frame + 1)
+		this->_backend->AnnounceConsumer(name.c_str());
 
-	void obs_destroy(void *data)
+	this->_elapsed_seconds += seconds;
+	if(this->_elapsed_seconds >= SEARCH_INTERVAL)
 	{
-		if(data)
-		{
-			reinterpret_cast<TsvReceiveSource *>(data)->~TsvReceiveSource();
-			bfree(data);
-		}
+		this->_elapsed_seconds = 0;
+
+		// Lookup requires the graphics context, defer to the next Render()
+		if(!this->_texture && !name.empty())
+			this->_image_changed = true;
 	}
+}
+
+void TsvReceiveSource::Prefetch(uint32_t /*cx*/, uint32_t /*cy*/)
+{
+	// Note: Main render callbacks run on the render thread with the graphics context held, before any view is rendered
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "Prefetch", this->_tex_name);
+	const uint64_t frame_index = this->_backend->GetVideoFrameIndex();
+
+	// Hidden sources are not copied. Once shown again, Render() copies the first frame itself
+	if(this->_drawn_frame == NO_FRAME || frame_index > this->_drawn_frame + 1)
+		return;
+
+	if(this->ReceiveFrame(frame_index))
+		this->_stats.Increment(TsvStats::FRAMES_PREFETCHED);
+}
 
-	uint32_t obs_get_width(void *data)
+void TsvReceiveSource::Render(gs_effect_t *effect)
+{
+	UNUSED_PARAMETER(effect);
+
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "Render", this->_tex_name);
+
+	// Note: Render() is called with the graphics context held, so neither locking nor entering graphics is required
+	const uint64_t frame_index = this->_backend->GetVideoFrameIndex();
+	this->_drawn_frame         = frame_index;
+
+	// Usually already done by Prefetch(). Sources drawn in several views are only copied once per video frame
+	if(this->_received_frame != frame_index)
+		this->ReceiveFrame(frame_index);
+
+	if(!this->_texture)
+		return;
+
+	// Draw texture
+	gs_texture_t *const texture = this->PresentFrame();
+	if(!texture)
+		return;
+
+	// Conversions are undone by the draw itself
+	const TsvConversion conversion = this->_settings->conversion.Inverse();
+	if(this->_tex_layout == TsvPixelLayout::RGBA)
+		this->_backend->DrawTexture(texture, conversion);
+	else
+		this->_backend->DrawPackedTexture(texture, this->_tex_layout, this->_image_width, this->_image_height,
+		                                  conversion);
+}
+
+bool TsvReceiveSource::ReceiveFrame(uint64_t frame_index)
+{
+	this->_received_frame = frame_index;
+	this->_published_settings.Adopt(this->_settings);
+
+	// Sender name or transport changed. Release texture of the previous image and lookup the new one
+	if(this->_tex_name != this->_settings->shared_texture_name || this->_tex_transport != this->_settings->transport)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->GetWidth();
+		this->DestroyTexture();
+
+		this->_tex_name       = this->_settings->shared_texture_name;
+		this->_tex_transport  = this->_settings->transport;
+		this->_tex_generation = TsvImageSync::UNKNOWN_GENERATION;
+		this->_cpu_sequence   = 0;
+		this->_image_changed  = true;
 	}
 
-	uint32_t obs_get_height(void *data)
+	// Crop changed. Looking the image up again recreates the texture at the new size
+	if(this->_tex_crop != this->_settings->crop)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->GetHeight();
+		this->_tex_crop      = this->_settings->crop;
+		this->_image_changed = true;
 	}
 
-	void obs_get_defaults(void *data, obs_data_t *defaults)
+	if(this->_tex_transport == TRANSPORT_SHARED_MEMORY)
+		return this->ReceiveCpuFrame();
+
+	// Nothing can be looked up or copied until the client connected in the background. Image changes reported in the
+	// meantime are looked up once it did
+	if(!this->_backend->IsClientConnected())
+		return false;
+
+	// Jitter buffer was resized. Drops the buffered frames
+	if(this->_jitter_buffer.GetCapacity() != this->_settings->jitter_buffer)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->GetDefaults(defaults);
+		this->_jitter_buffer.Resize(this->_settings->jitter_buffer, this->_tex_width, this->_tex_height,
+		                            this->_tex_format);
+		this->_tex_buffered = false;
+
+		// The texture may not hold the newest frame if it was received into the jitter buffer. Copy it again
+		if(this->_tex_bypassed)
+			this->_tex_generation = TsvImageSync::UNKNOWN_GENERATION;
 	}
 
-	obs_properties_t *obs_get_properties(void *data)
+	if(this->_image_changed.load(std::memory_order_relaxed) && this->_image_changed.exchange(false) &&
+	   !this->_tex_name.empty())
+		this->ImageSearchFunction();
+
+	if(!this->_texture && !this->_pending.texture)
+		return false;
+
+	// Only copy if the sender published a new frame. Senders without frame generation are copied every frame. A
+	// pending texture is filled with the current frame
+	const uint64_t generation = this->_backend->GetFrameGeneration(this->_tex_name.c_str());
+	if(generation != TsvImageSync::UNKNOWN_GENERATION && generation == this->_tex_generation &&
+	   !this->_pending.texture)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->GetProperties();
+		this->_stats.Increment(TsvStats::FRAMES_SKIPPED);
+		return false;
 	}
 
-	void obs_update(void *data, obs_data_t *settings)
+	// Check whether the shared texture has changed
+	this->_stats.Increment(TsvStats::IMAGE_LOOKUPS);
+	if(this->_backend->FindImage(this->_tex_name.c_str(), false) == ImageLookupResult::RequiresUpdate)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->UpdateProperties(settings);
+		TsvImageData data;
+		this->_stats.Increment(TsvStats::IMAGE_LOOKUPS);
+		if(this->_backend->FindImageData(this->_tex_name.c_str(), true, data))
+			this->UpdateTexture(data);
 	}
 
-	void obs_video_tick(void *data, float seconds)
+	const uint64_t timestamp_ns = generation != TsvImageSync::UNKNOWN_GENERATION
+	                                  ? this->_backend->GetFrameTimestamp(this->_tex_name.c_str(), generation)
+	                                  : TsvImageSync::UNKNOWN_TIMESTAMP;
+
+	if(this->_pending.texture)
+		return this->SwapPendingTexture(generation, timestamp_ns);
+
+	// Frames that are completely copied and buffered anyway are received straight into the jitter buffer, saving a
+	// copy. Frames without timestamp can't be paced and are drawn from the texture right away
+	const TsvImageRect region = this->GetRecvRegion(generation);
+	const bool bypass = this->_jitter_buffer.GetCapacity() > 0 && timestamp_ns != TsvImageSync::UNKNOWN_TIMESTAMP &&
+	                    region.width == this->_tex_region.width && region.height == this->_tex_region.height;
+
+	gs_texture_t *target = this->_texture;
+	if(bypass)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->OnTick(seconds);
+		bool dropped = false;
+		target       = this->_jitter_buffer.BeginPush(dropped);
+		if(dropped)
+			this->_stats.Increment(TsvStats::FRAMES_DROPPED);
 	}
 
-	void obs_video_render(void *data, gs_effect_t *effect)
+	// Receive shared image. Nothing to copy if only cropped parts changed
+	bool received = region.width == 0 || region.height == 0;
+	if(!received && target)
 	{
-		return reinterpret_cast<TsvReceiveSource *>(data)->Render(effect);
+		const TsvStats::ScopedTimer recv_timer(this->_stats, TsvStats::RECV_IMAGE);
+		const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "recv_image", this->_tex_name);
+		received = this->_backend->RecvImage(this->_tex_name.c_str(), target, region, region.x - this->_tex_region.x,
+		                                     region.y - this->_tex_region.y);
 	}
-}
 
-TsvReceiveSource::TsvReceiveSource(obs_data_t *settings, obs_source_t *source)
-	: _source(source)
-{
-	this->UpdateProperties(settings);
+	if(!received)
+		return false;
 
-	this->_tex_share_gl.init_with_server_launch();
-}
+	// Generations published since the previous copy were overwritten before they could be copied
+	if(this->_tex_generation != TsvImageSync::UNKNOWN_GENERATION && generation > this->_tex_generation + 1)
+		this->_stats.Increment(TsvStats::FRAMES_DROPPED, generation - this->_tex_generation - 1);
 
-TsvReceiveSource::~TsvReceiveSource()
-{
-	// Note: Enter graphics first to prevent race condition
-	obs_enter_graphics();
-	const auto lock = std::lock_guard(this->_access);
+	this->_tex_generation = generation;
+	this->_tex_bypassed   = bypass;
+	this->_stats.Increment(TsvStats::FRAMES_RECEIVED);
 
-	if(this->_texture)
+	if(bypass)
 	{
-		gs_texture_destroy(this->_texture);
-		this->_texture = nullptr;
+		this->_jitter_buffer.EndPush(timestamp_ns);
+		this->_tex_buffered = true;
 	}
+	else
+		this->OnFrameReceived(timestamp_ns);
 
-	this->_source = nullptr;
-
-	obs_leave_graphics();
+	return true;
 }
 
-uint32_t TsvReceiveSource::GetWidth()
+void TsvReceiveSource::OnFrameReceived(uint64_t timestamp_ns)
 {
-	return this->_tex_width;
+	// Frames without timestamp can't be paced and are drawn right away
+	this->_tex_buffered = this->_jitter_buffer.GetCapacity() > 0 && timestamp_ns != TsvImageSync::UNKNOWN_TIMESTAMP;
+	if(!this->_tex_buffered)
+		return this->RecordLatency(timestamp_ns);
+
+	// Note: Copies the texture on the GPU. Partial updates of _texture keep working, it holds the newest frame
+	if(!this->_jitter_buffer.Push(this->_texture, timestamp_ns))
+		this->_stats.Increment(TsvStats::FRAMES_DROPPED);
 }
 
-uint32_t TsvReceiveSource::GetHeight()
+gs_texture_t *TsvReceiveSource::PresentFrame()
 {
-	return this->_tex_height;
+	if(!this->_tex_buffered)
+		return this->_texture;
+
+	// Frames are drawn jitter_buffer video frames after they were captured. Video frame times are rounded, so allow
+	// half a frame of slack rather than holding a frame back for one more video frame
+	const double frame_rate = this->_backend->GetVideoFrameRate();
+	const uint64_t delay_ns =
+		frame_rate > 0 ? static_cast<uint64_t>((this->_settings->jitter_buffer - 0.5) * 1e9 / frame_rate) : 0;
+
+	const TsvJitterBuffer::PresentedFrame frame =
+		this->_jitter_buffer.Present(this->_backend->GetVideoFrameTime(), delay_ns);
+	if(frame.skipped > 0)
+		this->_stats.Increment(TsvStats::FRAMES_DROPPED, frame.skipped);
+
+	if(frame.is_new)
+		this->RecordLatency(frame.timestamp_ns);
+
+	// Until the first buffered frame is due, draw the texture. If frames bypassed it, it still holds the frame that was
+	// received into it when it was created
+	if(frame.texture)
+		return frame.texture;
+
+	return this->_texture;
 }
 
-obs_properties_t *TsvReceiveSource::GetProperties()
+void TsvReceiveSource::RecordLatency(uint64_t timestamp_ns)
 {
-	obs_properties_t *properties = obs_properties_create();
+	const uint64_t present_ns = this->_backend->GetVideoFrameTime();
+	if(timestamp_ns == TsvImageSync::UNKNOWN_TIMESTAMP || present_ns < timestamp_ns)
+	{
+		this->_last_latency_ns = 0;
+		return;
+	}
 
-	obs_properties_add_text(properties, PROPERTY_SHARED_TEXTURE_NAME.data(),
-	                        obs_module_text(PROPERTY_SHARED_TEXTURE_NAME.data()), OBS_TEXT_DEFAULT);
+	const uint64_t latency_ns = present_ns - timestamp_ns;
+	this->_stats.RecordDuration(TsvStats::LATENCY, std::chrono::nanoseconds(latency_ns));
 
-	return properties;
+	if(this->_last_latency_ns != 0)
+	{
+		const uint64_t jitter_ns = latency_ns > this->_last_latency_ns ? latency_ns - this->_last_latency_ns
+		                                                               : this->_last_latency_ns - latency_ns;
+		this->_stats.RecordDuration(TsvStats::JITTER, std::chrono::nanoseconds(jitter_ns));
+	}
+
+	this->_last_latency_ns = latency_ns;
 }
 
-void TsvReceiveSource::GetDefaults(obs_data_t *defaults)
+void TsvReceiveSource::ImageSearchFunction()
 {
-	obs_data_set_default_string(defaults, PROPERTY_SHARED_TEXTURE_NAME.data(),
-	                            obs_module_text(PROPERTY_SHARED_TEXTURE_NAME_DEFAULT.data()));
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "ImageSearchFunction",
+	                                  this->_tex_name);
+
+	TsvImageData data;
+	this->_stats.Increment(TsvStats::IMAGE_LOOKUPS);
+	if(this->_backend->FindImageData(this->_tex_name.c_str(), true, data))
+		this->UpdateTexture(data);
+	else
+	{
+		// Image was removed. Keep last known size so that the source doesn't collapse
+		this->DestroyTexture();
+	}
 }
 
-void TsvReceiveSource::UpdateProperties(obs_data_t *settings)
+bool TsvReceiveSource::ReceiveCpuFrame()
 {
-	// Check if sender name was updated
-	const char *new_sender_name = obs_data_get_string(settings, PROPERTY_SHARED_TEXTURE_NAME.data());
-	if(this->_shared_texture_name == new_sender_name)
-		return;
+	TsvCpuFrame frame;
+	if(this->_tex_name.empty() || !this->_backend->MapCpuFrame(this->_tex_name.c_str(), this->_cpu_sequence, frame))
+	{
+		this->_stats.Increment(TsvStats::FRAMES_SKIPPED);
+		return false;
+	}
 
-	// If name was updated, reinitialize texture
-	// Note: Enter graphics first to prevent race condition
-	obs_enter_graphics();
-	const auto lock = std::lock_guard(this->_access);
+	const TsvImageRect region = this->GetCropRegion(frame.width, frame.height);
+	if(!this->_texture || region.width != this->_tex_width || region.height != this->_tex_height ||
+	   frame.format != this->_tex_format)
+		this->UpdateCpuTexture(region.width, region.height, frame.format);
 
+	// Note: Uploaded straight from the mapped ring, without an intermediate copy. Cropping only offsets the first row
 	if(this->_texture)
 	{
-		gs_texture_destroy(this->_texture);
-		this->_texture = nullptr;
+		const uint8_t *const data = frame.data + static_cast<size_t>(region.y) * frame.linesize +
+		                            static_cast<size_t>(region.x) * (gs_get_format_bpp(frame.format) / 8);
+
+		const TsvStats::ScopedTimer read_timer(this->_stats, TsvStats::READ_CPU_FRAME);
+		this->_backend->SetTextureImage(this->_texture, data, frame.linesize);
+	}
+
+	// A torn frame is replaced with the next one the sender writes
+	if(!this->_backend->UnmapCpuFrame(this->_tex_name.c_str(), frame))
+	{
+		this->_stats.Increment(TsvStats::FRAMES_TORN);
+		return false;
 	}
 
-	obs_leave_graphics();
+	if(!this->_texture)
+		return false;
 
-	this->_shared_texture_name = obs_data_get_string(settings, PROPERTY_SHARED_TEXTURE_NAME.data());
+	this->_cpu_sequence = frame.sequence;
+	this->_stats.Increment(TsvStats::FRAMES_RECEIVED);
+
+	return true;
 }
 
-void TsvReceiveSource::OnTick(float seconds)
+void TsvReceiveSource::UpdateCpuTexture(uint32_t width, uint32_t height, gs_color_format format)
 {
-	this->_elapsed_seconds += seconds;
-	if(this->_elapsed_seconds >= SEARCH_INTERVAL)
-	{
-		this->_elapsed_seconds = 0;
+	this->DestroyTexture();
 
-		if(!this->_texture && !this->_shared_texture_name.empty())
-			this->ImageSearchFunction();
-	}
+	this->_texture = this->_backend->CreateDynamicTexture(width, height, format);
+	this->_stats.Increment(TsvStats::RESIZES);
+
+	this->_tex_width    = width;
+	this->_tex_height   = height;
+	this->_tex_format   = format;
+	this->_tex_layout   = TsvPixelLayout::RGBA;
+	this->_image_width  = width;
+	this->_image_height = height;
+
+	this->StoreImageInfo();
 }
 
-void TsvReceiveSource::Render(gs_effect_t *effect)
+TsvImageRect TsvReceiveSource::GetCropRegion(uint32_t width, uint32_t height) const
 {
-	// Note: Enter graphics before acuiring _lock to prevent race condition
-	obs_enter_graphics();
+	if(width == 0 || height == 0)
+		return TsvImageRect{0, 0, width, height};
 
-	// Get default obs effect for drawing
-	effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	const Crop &crop = this->_settings->crop;
 
-	if(this->_texture)
+	TsvImageRect region;
+	region.x      = std::min(crop.left, width - 1);
+	region.y      = std::min(crop.top, height - 1);
+	region.width  = width - region.x - std::min(crop.right, width - region.x - 1);
+	region.height = height - region.y - std::min(crop.bottom, height - region.y - 1);
+
+	return region;
+}
+
+void TsvReceiveSource::DestroyTexture()
+{
+	// Drop buffered frames. Render() sets the jitter buffer up again
+	this->_jitter_buffer.Clear();
+	this->_tex_buffered    = false;
+	this->_tex_bypassed    = false;
+	this->_last_latency_ns = 0;
+
+	this->DestroyPendingTexture();
+
+	if(!this->_texture)
+		return;
+
+	// Textures for CPU frames are not pooled
+	if(this->_tex_transport == TRANSPORT_SHARED_MEMORY)
+		this->_backend->DestroyDynamicTexture(this->_texture);
+	else
+		this->_backend->DestroyTexture(this->_texture);
+
+	this->_texture = nullptr;
+}
+
+void TsvReceiveSource::DestroyPendingTexture()
+{
+	if(!this->_pending.texture)
+		return;
+
+	this->_backend->DestroyTexture(this->_pending.texture);
+	this->_pending.texture = nullptr;
+}
+
+bool TsvReceiveSource::SwapPendingTexture(uint64_t generation, uint64_t timestamp_ns)
+{
+	// The previous frame stays on screen until the pending texture holds a complete frame. Not received straight into
+	// the jitter buffer, which still has the previous size
+	bool received = false;
 	{
-		const auto lock = std::lock_guard(this->_access);
+		const TsvStats::ScopedTimer recv_timer(this->_stats, TsvStats::RECV_IMAGE);
+		const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "recv_image", this->_tex_name);
+		received = this->_backend->RecvImage(this->_tex_name.c_str(), this->_pending.texture, this->_pending.region,
+		                                     0, 0);
+	}
 
-		// Check whether the shared texture has changed
-		if(this->_tex_share_gl.find_image(this->_shared_texture_name.c_str(), false) ==
-		   ImageLookupResult::RequiresUpdate)
-		{
-			const auto data_lock = this->_tex_share_gl.find_image_data(this->_shared_texture_name.c_str(), true);
+	if(!received)
+		return false;
 
-			const auto *data = data_lock.read();
-			if(data != nullptr)
-			{
-				const uint32_t tex_width         = data->width;
-				const uint32_t tex_height        = data->height;
-				const gs_color_format tex_format = GetSharedTextureFormat(data->format);
+	// Note: Also drops the frames buffered at the previous size
+	gs_texture_t *const texture = std::exchange(this->_pending.texture, nullptr);
+	this->DestroyTexture();
 
-				this->UpdateTexture(tex_width, tex_height, tex_format);
-			}
-		}
+	const PendingTexture &pending = this->_pending;
+	this->_texture                = texture;
+	this->_tex_region             = pending.region;
+	this->_tex_width              = pending.region.width;
+	this->_tex_height             = pending.region.height;
+	this->_tex_format             = pending.format;
+	this->_tex_layout             = pending.layout;
+	this->_image_width            = pending.image_width;
+	this->_image_height           = pending.image_height;
+	this->_tex_generation         = generation;
 
-		// Receive shared image
-		GLuint *const gl_texture = reinterpret_cast<GLuint *>(gs_texture_get_obj(this->_texture));
-		if(gl_texture)
-		{
-			const GlImageExtent image_size{
-				{0,						 0						 },
-				{(GLsizei)this->_tex_width, (GLsizei)this->_tex_height},
-			};
+	this->_jitter_buffer.Resize(this->_settings->jitter_buffer, this->_tex_width, this->_tex_height,
+	                            this->_tex_format);
+	this->_stats.Increment(TsvStats::FRAMES_RECEIVED);
 
-			GLint drawFboId = 0;
-			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFboId);
+	this->StoreImageInfo();
 
-			this->_tex_share_gl.recv_image(this->_shared_texture_name.c_str(), *gl_texture, GL_TEXTURE_2D, false,
-			                               drawFboId, &image_size);
-		}
+	// Nothing is buffered yet, so the frame is drawn from the texture right away
+	this->OnFrameReceived(timestamp_ns);
 
-		// Draw texture
-		while(gs_effect_loop(effect, "Draw"))
-		{
-			obs_source_draw(this->_texture, 0, 0, 0, 0, false);
-		}
+	return true;
+}
+
+TsvImageRect TsvReceiveSource::GetRecvRegion(uint64_t generation)
+{
+	const TsvImageRect &image = this->_tex_region;
+
+	// The changed region is only sufficient if the texture holds the directly preceding frame
+	TsvImageRect damage;
+	if(this->_tex_generation == TsvImageSync::UNKNOWN_GENERATION || generation != this->_tex_generation + 1 ||
+	   this->_tex_bypassed || !this->_backend->GetFrameDamage(this->_tex_name.c_str(), generation, damage))
+		return image;
+
+	// Damage is extended to TsvImageSync::DAMAGE_GRANULARITY and may exceed the image. Only its cropped part is copied
+	const uint32_t left   = std::max(damage.x, image.x);
+	const uint32_t top    = std::max(damage.y, image.y);
+	const uint32_t right  = std::min(damage.x + damage.width, image.x + image.width);
+	const uint32_t bottom = std::min(damage.y + damage.height, image.y + image.height);
+
+	TsvImageRect region{left, top, 0, 0};
+	if(right > left && bottom > top)
+	{
+		region.width  = right - left;
+		region.height = bottom - top;
 	}
 
-	obs_leave_graphics();
+	if(region.width < image.width || region.height < image.height)
+		this->_stats.Increment(TsvStats::FRAMES_PARTIAL);
+
+	return region;
 }
 
-void TsvReceiveSource::ImageSearchFunction()
+bool TsvReceiveSource::UpdateTexture(const TsvImageData &data)
 {
-	obs_enter_graphics();
-	const auto lock = std::lock_guard(this->_access);
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "UpdateTexture", this->_tex_name);
 
-	const auto data_lock = this->_tex_share_gl.find_image_data(this->_shared_texture_name.c_str(), true);
-	const auto *data     = data_lock.read();
-	if(data != nullptr)
+	const gs_color_format format = GetSharedTextureFormat(data.format);
+
+	// Senders without image info share RGBA. Also fall back to RGBA while the image info doesn't match the image yet
+	TsvPixelLayout::LAYOUT layout = TsvPixelLayout::RGBA;
+	uint32_t image_width          = data.width;
+	uint32_t image_height         = data.height;
+	if(this->_backend->GetImageLayout(this->_tex_name.c_str(), layout, image_width, image_height))
 	{
-		const uint32_t tex_width         = data->width;
-		const uint32_t tex_height        = data->height;
-		const gs_color_format tex_format = GetSharedTextureFormat(data->format);
+		uint32_t packed_width, packed_height;
+		TsvPixelLayout::GetPackedSize(layout, image_width, image_height, packed_width, packed_height);
+		if(packed_width != data.width || packed_height != data.height)
+		{
+			layout       = TsvPixelLayout::RGBA;
+			image_width  = data.width;
+			image_height = data.height;
+		}
+	}
 
-		this->UpdateTexture(tex_width, tex_height, tex_format);
+	// Packed images are always copied completely, cropped parts of them would be scattered across the texture
+	TsvImageRect region{0, 0, data.width, data.height};
+	if(layout == TsvPixelLayout::RGBA)
+	{
+		region       = this->GetCropRegion(data.width, data.height);
+		image_width  = region.width;
+		image_height = region.height;
 	}
 
-	obs_leave_graphics();
-}
+	// Already up to date, or a texture for this image is already pending
+	if(this->_texture && region == this->_tex_region && format == this->_tex_format && layout == this->_tex_layout &&
+	   image_width == this->_image_width && image_height == this->_image_height)
+	{
+		this->DestroyPendingTexture();
+		return true;
+	}
 
-bool TsvReceiveSource::UpdateTexture(uint32_t width, uint32_t height, gs_color_format format)
-{
-	if(this->_texture)
-		gs_texture_destroy(this->_texture);
+	if(this->_pending.texture && region == this->_pending.region && format == this->_pending.format &&
+	   layout == this->_pending.layout && image_width == this->_pending.image_width &&
+	   image_height == this->_pending.image_height)
+		return true;
 
-	// Create texture
-	this->_texture = gs_texture_create(width, height, format, 1, nullptr, 0);
+	// Create texture. Its content is undefined until the first frame was received into it, so the current texture is
+	// drawn until then
+	this->DestroyPendingTexture();
+	this->_pending.texture = this->_backend->CreateTexture(region.width, region.height, format);
+	this->_stats.Increment(TsvStats::RESIZES);
 
-	this->_tex_width  = width;
-	this->_tex_height = height;
-	this->_tex_format = format;
+	this->_pending.region       = region;
+	this->_pending.format       = format;
+	this->_pending.layout       = layout;
+	this->_pending.image_width  = image_width;
+	this->_pending.image_height = image_height;
 
 	return true;
 }
 
+void TsvReceiveSource::StoreImageInfo()
+{
+	this->_last_width.store(this->_image_width, std::memory_order_relaxed);
+	this->_last_height.store(this->_image_height, std::memory_order_relaxed);
+	this->_last_format.store(this->_tex_format, std::memory_order_relaxed);
+}
+
+void TsvReceiveSource::GetStatsCb(void *data, calldata_t *cd)
+{
+	const TsvReceiveSource *const source = reinterpret_cast<TsvReceiveSource *>(data);
+	calldata_set_string(cd, "stats", source->_stats.ToJson(source->_access).c_str());
+}
+
+void TsvReceiveSource::PrefetchCb(void *param, uint32_t cx, uint32_t cy)
+{
+	return reinterpret_cast<TsvReceiveSource *>(param)->Prefetch(cx, cy);
+}
+
 gs_color_format TsvReceiveSource::GetSharedTextureFormat(ImgFormat format)
 {
 	switch(format)
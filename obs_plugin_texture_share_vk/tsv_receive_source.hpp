@@ -1,14 +1,25 @@
 #pragma once
 
+#include "tsv_backend.hpp"
+#include "tsv_image_sync.hpp"
+#include "tsv_jitter_buffer.hpp"
+#include "tsv_mutex.hpp"
+#include "tsv_snapshot.hpp"
+#include "tsv_stats.hpp"
+
 #include <obs-module.h>
 // #include <obs/graphics/graphics.h>
 #include <texture_share_gl/texture_share_gl_client.hpp>
 
+#include <atomic>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <string_view>
 
-/*! \brief Texture sharing filter. Uses offscreen rendering to send source texture to other programs.
+/*! \brief Texture sharing source. Draws an image shared by another program or a TsvSendFilter. New frames are copied
+ * from the shared texture, or uploaded from a shared memory frame ring, by a main render callback (Prefetch()) before
+ * the views are rendered, so that drawing the source only draws its texture
  */
 class TsvReceiveSource
 {
@@ -16,11 +27,41 @@ class TsvReceiveSource
 	static constexpr std::string_view PLUGIN_NAME                          = "texture-share-vk-source-plugin";
 	static constexpr std::string_view PROPERTY_SHARED_TEXTURE_NAME         = "shared_texture_name";
 	static constexpr std::string_view PROPERTY_SHARED_TEXTURE_NAME_DEFAULT = "obs_shared";
+	static constexpr std::string_view PROPERTY_TRANSPORT                   = "transport";
+	static constexpr std::string_view PROPERTY_TRANSPORT_GPU               = "transport_gpu";
+	static constexpr std::string_view PROPERTY_TRANSPORT_SHARED_MEMORY     = "transport_shared_memory";
+	static constexpr std::string_view PROPERTY_JITTER_BUFFER               = "jitter_buffer";
+	static constexpr std::string_view PROPERTY_CROP_LEFT                   = "crop_left";
+	static constexpr std::string_view PROPERTY_CROP_TOP                    = "crop_top";
+	static constexpr std::string_view PROPERTY_CROP_RIGHT                  = "crop_right";
+	static constexpr std::string_view PROPERTY_CROP_BOTTOM                 = "crop_bottom";
+
+	// Hidden settings. Last known image size and format, used until the shared image was found after loading a scene
+	static constexpr std::string_view PROPERTY_LAST_WIDTH  = "last_width";
+	static constexpr std::string_view PROPERTY_LAST_HEIGHT = "last_height";
+	static constexpr std::string_view PROPERTY_LAST_FORMAT = "last_format";
 
-	// Time (in seconds) between searches for shared textures
+	// Time (in seconds) between searches for shared textures. Only used for senders that don't publish image info,
+	// all others are found by the TsvImageWatcher thread
 	static constexpr float SEARCH_INTERVAL = 1.0;
 
-	TsvReceiveSource(obs_data_t *settings, obs_source_t *source);
+	// Upper bound of the jitter_buffer property (in video frames). 0 draws each frame as soon as it was copied
+	static constexpr uint32_t MAX_JITTER_BUFFER = 8;
+
+	// Upper bound of the crop properties (in pixels)
+	static constexpr uint32_t MAX_CROP = 16384;
+
+	/*! \brief How the source obtains frames
+	 */
+	enum TRANSPORT
+	{
+		// Copy the texture share server's image on the GPU
+		TRANSPORT_GPU,
+		// Upload frames from the sender's shared memory frame ring, see the send filter's cpu_transport
+		TRANSPORT_SHARED_MEMORY,
+	};
+
+	TsvReceiveSource(obs_data_t *settings, obs_source_t *source, std::unique_ptr<TsvBackend> backend);
 	~TsvReceiveSource();
 
 	/*! \brief Get source width
@@ -41,26 +82,105 @@ class TsvReceiveSource
 	 */
 	void UpdateProperties(obs_data_t *settings);
 
-	/*! \brief Renders texture (in separate thread?). Waits for filter notification that more data is available
+	/*! \brief Store the last known image size and format in settings. Called on the UI thread when OBS saves the source
+	 */
+	void SaveSettings(obs_data_t *settings);
+
+	/*! \brief Main render callback. Copies a new frame into the texture before the views are rendered, so that Render()
+	 * only draws it. Skipped if the source was not drawn in the previous video frame
 	 */
-	// void OffscreenRender(uint32_t cx, uint32_t cy);
+	void Prefetch(uint32_t cx, uint32_t cy);
 
-	/*! \brief Called every frame with the amount of elapsed settings. Regulates how often _tex_share_gl looks for
-	 * images
+	/*! \brief Called every video frame with the elapsed time in seconds. Adopts settings written by the UI thread,
+	 * announces the source as consumer of its image if it was drawn in the previous frame, and schedules another image
+	 * lookup every SEARCH_INTERVAL while no image was found
 	 */
 	void OnTick(float seconds);
 
-	/*! \brief Filter update. Only notifies offscreen renderer that new information is available
+	/*! \brief Draw the newest frame. Copies it first, unless Prefetch() already did so in this video frame
 	 */
 	void Render(gs_effect_t *effect);
 
+	/*! \brief Access mutex. Serializes settings updates, never taken on the render thread. Exposed for lock hold time
+	 * measurements
+	 */
+	const TsvMutex &GetAccessMutex() const
+	{
+		return this->_access;
+	}
+
+	/*! \brief Performance counters. Also available via the get_stats proc handler
+	 */
+	const TsvStats &GetStats() const
+	{
+		return this->_stats;
+	}
+
 	private:
-	std::mutex _access;
+	// Video frame index before the first Render() or ReceiveFrame()
+	static constexpr uint64_t NO_FRAME = UINT64_MAX;
+
+	/*! \brief Pixels removed from each edge of the shared image
+	 */
+	struct Crop
+	{
+		uint32_t left   = 0;
+		uint32_t top    = 0;
+		uint32_t right  = 0;
+		uint32_t bottom = 0;
+
+		bool operator==(const Crop &other) const = default;
+	};
+
+	/*! \brief Texture for the shared image after a resize, and the part of the image it holds
+	 */
+	struct PendingTexture
+	{
+		TsvImageRect region;
+		gs_texture_t *texture         = nullptr;
+		gs_color_format format        = GS_UNKNOWN;
+		TsvPixelLayout::LAYOUT layout = TsvPixelLayout::RGBA;
+		uint32_t image_width          = 0;
+		uint32_t image_height         = 0;
+	};
 
-	TextureShareGlClient _tex_share_gl;
-	std::string _shared_texture_name;
+	/*! \brief Settings used by the render thread. Written on the UI thread and handed over as immutable snapshot
+	 */
+	struct Settings
+	{
+		std::string shared_texture_name;
+		TRANSPORT transport = TRANSPORT_GPU;
+
+		// Delay (in video frames) by which frames are held back to absorb arrival jitter. 0: No jitter buffer
+		uint32_t jitter_buffer = 0;
+
+		// Only this part of the image is copied. Not applied to packed pixel layouts
+		Crop crop;
+
+		// Record trace events, see TsvTrace
+		bool trace = false;
+
+		// Conversions the sender applied. Undone while drawing
+		TsvConversion conversion;
+	};
+
+	TsvMutex _access;
+	TsvStats _stats;
+
+	std::unique_ptr<TsvBackend> _backend;
 	float _elapsed_seconds = 0;
 
+	// Settings most recently written by the UI thread. Guarded by _access
+	Settings _written_settings;
+	TsvSnapshot<Settings> _published_settings;
+
+	// Settings snapshot of the render thread. Replaced at the start of OnTick() and Render()
+	std::unique_ptr<const Settings> _settings = std::make_unique<const Settings>();
+
+	// Name of the shared image and transport _texture was created for. Only accessed by the render thread
+	std::string _tex_name;
+	TRANSPORT _tex_transport = TRANSPORT_GPU;
+
 	obs_source_t *_source  = nullptr;
 	gs_texture_t *_texture = nullptr;
 
@@ -68,11 +188,122 @@ class TsvReceiveSource
 	uint32_t _tex_height        = 0;
 	gs_color_format _tex_format = GS_UNKNOWN;
 
+	// Crop _texture was created for
+	Crop _tex_crop;
+
+	// Region of the shared image stored in _texture. Covers the whole image unless cropped
+	TsvImageRect _tex_region;
+
+	// Pixel layout of the shared image and size of the unpacked, cropped image. Equals the texture size for RGBA
+	TsvPixelLayout::LAYOUT _tex_layout = TsvPixelLayout::RGBA;
+	uint32_t _image_width              = 0;
+	uint32_t _image_height             = 0;
+
+	// Last known unpacked image size and format. Written by the render thread, read by GetWidth()/GetHeight() from any
+	// thread and stored in the settings by SaveSettings()
+	std::atomic<uint32_t> _last_width         = 0;
+	std::atomic<uint32_t> _last_height        = 0;
+	std::atomic<gs_color_format> _last_format = GS_UNKNOWN;
+
+	// Texture created for a resized image. Until a frame was received into it, _texture is still drawn at the previous
+	// size. See SwapPendingTexture()
+	PendingTexture _pending;
+
+	// Frame generation of the image currently stored in _texture
+	uint64_t _tex_generation = TsvImageSync::UNKNOWN_GENERATION;
+
+	// Sequence of the CPU frame currently stored in _texture. 0 if none
+	uint64_t _cpu_sequence = 0;
+
+	// Copies of received frames, drawn paced to their capture time. Only used for frames with a timestamp
+	TsvJitterBuffer _jitter_buffer;
+
+	// Whether the newest frame was queued in the jitter buffer, which then provides the frame to draw
+	bool _tex_buffered = false;
+
+	// Whether the newest frame was received straight into the jitter buffer. _texture then holds an older frame
+	bool _tex_bypassed = false;
+
+	// Latency of the previously drawn frame. 0 if unknown
+	uint64_t _last_latency_ns = 0;
+
+	// Video frame in which ReceiveFrame() last ran and in which the source was last drawn
+	uint64_t _received_frame = NO_FRAME;
+	uint64_t _drawn_frame    = NO_FRAME;
+
+	// Set by the image watcher thread when the shared image was created, resized or removed. Also set by the render
+	// thread to request a lookup on the next frame
+	std::atomic<bool> _image_changed = false;
+
+	/*! \brief Lookup shared image and (re-)initialize texture. Releases texture if the image no longer exists. Must be
+	 * called from Render()
+	 */
 	void ImageSearchFunction();
 
-	/*! \brief (Re-)initialize texture for copying
+	/*! \brief Adopt the current settings and copy a new frame of the shared image into the texture. Returns true if a
+	 * new frame was copied
+	 */
+	bool ReceiveFrame(uint64_t frame_index);
+
+	/*! \brief Queue the frame newly copied into the texture in the jitter buffer, or record its latency if it is drawn
+	 * right away
+	 */
+	void OnFrameReceived(uint64_t timestamp_ns);
+
+	/*! \brief Get the texture to draw. With jitter buffer, this is the newest buffered frame that is due
+	 */
+	gs_texture_t *PresentFrame();
+
+	/*! \brief Record end-to-end latency of a frame drawn for the first time, and its difference to the previous one
+	 */
+	void RecordLatency(uint64_t timestamp_ns);
+
+	/*! \brief Upload the newest CPU frame from the shared memory frame ring into the texture. Returns true if a new
+	 * frame was uploaded
+	 */
+	bool ReceiveCpuFrame();
+
+	/*! \brief (Re-)create the texture for uploading CPU frames of the given (cropped) size and format
 	 */
-	bool UpdateTexture(uint32_t cx, uint32_t cy, gs_color_format format);
+	void UpdateCpuTexture(uint32_t width, uint32_t height, gs_color_format format);
+
+	/*! \brief Get the region of a width x height image that remains after cropping. Keeps at least one pixel
+	 */
+	TsvImageRect GetCropRegion(uint32_t width, uint32_t height) const;
+
+	/*! \brief Release texture, pending texture and buffered frames. Requires graphics context
+	 */
+	void DestroyTexture();
+
+	/*! \brief Release the pending texture, if any. Requires graphics context
+	 */
+	void DestroyPendingTexture();
+
+	/*! \brief Copy the complete shared image into the pending texture. Once that succeeded, it replaces the texture
+	 * and is drawn right away. Returns true if it was swapped
+	 */
+	bool SwapPendingTexture(uint64_t generation, uint64_t timestamp_ns);
+
+	/*! \brief Get the region of the shared image that has to be copied to update the texture to the given frame
+	 * generation. Only the region that changed is copied if the texture holds the preceding generation. Empty if only
+	 * cropped parts changed
+	 */
+	TsvImageRect GetRecvRegion(uint64_t generation);
+
+	/*! \brief (Re-)initialize texture for copying the shared image described by data. Keeps the current texture if
+	 * size, format and pixel layout didn't change. Otherwise, a pending texture is created and swapped in once it holds
+	 * a frame
+	 */
+	bool UpdateTexture(const TsvImageData &data);
+
+	/*! \brief Publish unpacked image size and format to GetWidth()/GetHeight() and SaveSettings(). Called on the render
+	 * thread, which must not touch the source settings
+	 */
+	void StoreImageInfo();
 
 	static gs_color_format GetSharedTextureFormat(ImgFormat format);
+
+	static void PrefetchCb(void *param, uint32_t cx, uint32_t cy);
+
+	static void GetStatsCb(void *data, calldata_t *cd);
 };
@@ -0,0 +1,184 @@
+#include "tsv_render_ring.hpp"
+
+
+TsvRenderRing::TsvRenderRing(TsvBackend &backend)
+	: _backend(backend)
+{}
+
+TsvRenderRing::~TsvRenderRing()
+{
+	this->Clear();
+}
+
+size_t TsvRenderRing::GetSize() const
+{
+	return this->_slots.size();
+}
+
+gs_color_format TsvRenderRing::GetFormat() const
+{
+	return this->_format;
+}
+
+void TsvRenderRing::Resize(size_t count, uint32_t width, uint32_t height, gs_color_format format)
+{
+	this->Clear();
+	this->_slots.resize(count);
+
+	this->_width  = width;
+	this->_height = height;
+	this->_format = format;
+}
+
+void TsvRenderRing::Clear()
+{
+	for(Slot &slot : this->_slots)
+	{
+		this->ReleaseFence(slot);
+
+		if(slot.texrender)
+			this->_backend.DestroyTexrender(slot.texrender);
+	}
+
+	this->_slots.clear();
+	this->_render_slot = 0;
+}
+
+gs_texrender_t *TsvRenderRing::AcquireRenderTarget()
+{
+	if(this->_slots.empty())
+		return nullptr;
+
+	// Prefer free slots, then drop the oldest pending frame, and only then overwrite the last published frame
+	Slot *free_slot      = nullptr;
+	Slot *oldest_pending = nullptr;
+	Slot *published      = nullptr;
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.state == PENDING)
+		{
+			if(!oldest_pending || slot.sequence < oldest_pending->sequence)
+				oldest_pending = &slot;
+		}
+		else if(slot.state == PUBLISHED)
+			published = &slot;
+		else if(!free_slot)
+			free_slot = &slot;
+	}
+
+	Slot &slot = free_slot ? *free_slot : (oldest_pending ? *oldest_pending : *published);
+	if(slot.state == PENDING)
+		++this->_dropped_frames;
+
+	this->ReleaseFence(slot);
+
+	if(!slot.texrender)
+		slot.texrender = this->_backend.CreateTexrender(this->_width, this->_height, this->_format);
+
+	slot.state         = RENDERING;
+	this->_render_slot = &slot - this->_slots.data();
+
+	return slot.texrender;
+}
+
+void TsvRenderRing::SubmitRenderTarget(uint64_t timestamp_ns)
+{
+	Slot &slot = this->_slots[this->_render_slot];
+
+	slot.fence        = this->_backend.CreateFence();
+	slot.sequence     = ++this->_sequence;
+	slot.timestamp_ns = timestamp_ns;
+	slot.state        = PENDING;
+}
+
+void TsvRenderRing::ReleaseRenderTarget()
+{
+	this->_slots[this->_render_slot].state = FREE;
+}
+
+gs_texrender_t *TsvRenderRing::PopReadyFrame()
+{
+	// Fences signal in submission order. Search for the newest signaled one
+	Slot *ready = nullptr;
+	for(Slot &slot : this->_slots)
+	{
+		if(slot.state != PENDING || (ready && slot.sequence < ready->sequence))
+			continue;
+
+		if(this->_backend.IsFenceSignaled(slot.fence))
+			ready = &slot;
+	}
+
+	if(!ready)
+		return nullptr;
+
+	for(Slot &slot : this->_slots)
+	{
+		if(&slot == ready)
+			continue;
+
+		// Drop frames older than the ready one
+		if(slot.state == PENDING && slot.sequence < ready->sequence)
+		{
+			this->ReleaseFence(slot);
+			slot.state = FREE;
+			++this->_dropped_frames;
+		}
+		else if(slot.state == PUBLISHED)
+			slot.state = FREE;
+	}
+
+	this->ReleaseFence(*ready);
+	ready->state = PUBLISHED;
+
+	return ready->texrender;
+}
+
+gs_texrender_t *TsvRenderRing::GetPreviousFrame() const
+{
+	if(this->_sequence == 0)
+		return nullptr;
+
+	for(const Slot &slot : this->_slots)
+	{
+		if((slot.state == PENDING || slot.state == PUBLISHED) && slot.sequence == this->_sequence)
+			return slot.texrender;
+	}
+
+	return nullptr;
+}
+
+size_t TsvRenderRing::GetSlot(gs_texrender_t *texrender) const
+{
+	for(size_t i = 0; i < this->_slots.size(); ++i)
+	{
+		if(this->_slots[i].texrender == texrender)
+			return i;
+	}
+
+	return this->_slots.size();
+}
+
+uint64_t TsvRenderRing::GetSequence(size_t slot) const
+{
+	return slot < this->_slots.size() ? this->_slots[slot].sequence : 0;
+}
+
+uint64_t TsvRenderRing::GetTimestamp(size_t slot) const
+{
+	return slot < this->_slots.size() ? this->_slots[slot].timestamp_ns : 0;
+}
+
+uint64_t TsvRenderRing::GetDroppedFrames() const
+{
+	return this->_dropped_frames;
+}
+
+void TsvRenderRing::ReleaseFence(Slot &slot)
+{
+	if(slot.fence)
+	{
+		this->_backend.DestroyFence(slot.fence);
+		slot.fence = nullptr;
+	}
+}
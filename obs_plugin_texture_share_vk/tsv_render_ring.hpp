@@ -0,0 +1,109 @@
+#pragma once
+
+#include "tsv_backend.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Ring of render targets guarded by GPU fences. A frame is rendered into a free slot and fenced, and only
+ * published once the GPU finished rendering it. Never blocks: if no slot is free, the oldest unpublished frame is
+ * dropped.
+ */
+class TsvRenderRing
+{
+	public:
+	explicit TsvRenderRing(TsvBackend &backend);
+	~TsvRenderRing();
+
+	TsvRenderRing(const TsvRenderRing &)            = delete;
+	TsvRenderRing &operator=(const TsvRenderRing &) = delete;
+
+	/*! \brief Number of render targets
+	 */
+	size_t GetSize() const;
+
+	/*! \brief Format of the render targets
+	 */
+	gs_color_format GetFormat() const;
+
+	/*! \brief Drop all frames and change the number, size and format of render targets. Requires graphics context
+	 */
+	void Resize(size_t count, uint32_t width, uint32_t height, gs_color_format format);
+
+	/*! \brief Destroy all render targets and fences. Requires graphics context
+	 */
+	void Clear();
+
+	/*! \brief Get render target for the next frame. Must be followed by SubmitRenderTarget or ReleaseRenderTarget
+	 */
+	gs_texrender_t *AcquireRenderTarget();
+
+	/*! \brief Fence the acquired render target. Its frame can be published once the fence signaled. timestamp_ns is the
+	 * time the frame was captured at
+	 */
+	void SubmitRenderTarget(uint64_t timestamp_ns);
+
+	/*! \brief Return the acquired render target to the free slots without fencing it
+	 */
+	void ReleaseRenderTarget();
+
+	/*! \brief Get the newest completely rendered frame without waiting. Older unpublished frames are dropped.
+	 * Returns nullptr if no frame is ready
+	 */
+	gs_texrender_t *PopReadyFrame();
+
+	/*! \brief Get the most recently submitted frame, if the ring still holds it. Can be called while rendering the next
+	 * frame, e.g. to compare both
+	 */
+	gs_texrender_t *GetPreviousFrame() const;
+
+	/*! \brief Index of the slot holding texrender. Can be used to associate per frame data with a slot
+	 */
+	size_t GetSlot(gs_texrender_t *texrender) const;
+
+	/*! \brief Submission sequence number of the frame in slot. Consecutive frames have consecutive sequence numbers, 0
+	 * if the slot's frame was never submitted
+	 */
+	uint64_t GetSequence(size_t slot) const;
+
+	/*! \brief Capture time of the frame in slot, as passed to SubmitRenderTarget
+	 */
+	uint64_t GetTimestamp(size_t slot) const;
+
+	/*! \brief Number of rendered frames that were never published
+	 */
+	uint64_t GetDroppedFrames() const;
+
+	private:
+	enum SLOT_STATE
+	{
+		FREE,
+		RENDERING,
+		PENDING,
+		// Last published frame. Not overwritten while other slots are available, as the copy may still be in flight
+		PUBLISHED,
+	};
+
+	struct Slot
+	{
+		gs_texrender_t *texrender = nullptr;
+		TsvBackend::fence_t fence = nullptr;
+		uint64_t sequence         = 0;
+		uint64_t timestamp_ns     = 0;
+		SLOT_STATE state          = FREE;
+	};
+
+	TsvBackend &_backend;
+
+	std::vector<Slot> _slots;
+	size_t _render_slot = 0;
+
+	uint32_t _width         = 0;
+	uint32_t _height        = 0;
+	gs_color_format _format = GS_RGBA;
+
+	uint64_t _sequence       = 0;
+	uint64_t _dropped_frames = 0;
+
+	void ReleaseFence(Slot &slot);
+};
@@ -1,238 +1,668 @@
 #include "tsv_send_filter.hpp"
 
+#include "tsv_instance_registry.hpp"
+#include "tsv_send_scheduler.hpp"
+#include "tsv_trace.hpp"
+
 #include <obs.h>
-// #include <obs/graphics/graphics.h>
-
-
-extern "C"
-{
-	/* Required OBS module commands (required) */
-	OBS_DECLARE_MODULE();
-	OBS_MODULE_USE_DEFAULT_LOCALE(OBSPluginTextureShareFilter::PLUGIN_NAME.data(), "en-US");
-
-	// Define plugin info
-	const char *obs_get_name(void *type_data);
-	void *obs_create(obs_data_t *settings, obs_source_t *source);
-	void obs_destroy(void *data);
-	// uint32_t    obs_get_width(void *data);
-	// uint32_t    obs_get_height(void *data);
-	void obs_get_defaults(void *data, obs_data_t *defaults);
-	obs_properties_t *obs_get_properties(void *data);
-	void obs_update(void *data, obs_data_t *settings);
-	void obs_video_render(void *data, gs_effect_t *effect);
-	void obs_offscreen_render(void *param, uint32_t cx, uint32_t cy);
-
-	constexpr struct obs_source_info obs_plugin_shared_texture_filter_info = {
-		.id             = TsvSendFilter::PLUGIN_NAME.data(),
-		.type           = OBS_SOURCE_TYPE_FILTER,
-		.output_flags   = OBS_SOURCE_VIDEO,
-		.get_name       = obs_get_name,
-		.create         = obs_create,
-		.destroy        = obs_destroy,
-		.get_properties = obs_get_properties,
-		.update         = obs_update,
-		.video_render   = obs_video_render,
-		.get_defaults2  = obs_get_defaults,
-	};
-
-	// Load module
-	bool obs_module_load(void)
-	{
-		obs_register_source(&obs_plugin_shared_texture_filter_info);
 
-		return true;
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+
+namespace
+{
+	// Assigns send phases to filters in creation order
+	std::atomic<uint32_t> next_send_phase = 0;
+} // namespace
+
+
+TsvSendFilter::TsvSendFilter(obs_data_t *settings, obs_source_t *source, std::unique_ptr<TsvBackend> backend)
+	: _backend(std::move(backend)),
+	  _source(source),
+	  _render_ring(*this->_backend),
+	  _damage_tracker(*this->_backend),
+	  _frame_readback(*this->_backend)
+{
+	this->_send_phase = next_send_phase++;
+
+	this->UpdateSharedTextureName(settings);
+	this->UpdateProperties(settings);
+	this->AdoptSettings();
+
+	TsvSendScheduler::GetInstance().Register(this, *this->_backend);
+
+	if(this->_source)
+	{
+		proc_handler_t *const proc_handler = obs_source_get_proc_handler(this->_source);
+		proc_handler_add(proc_handler, TsvStats::PROC_GET_STATS.data(), &TsvSendFilter::GetStatsCb, this);
+		proc_handler_add(proc_handler, TsvTrace::PROC_GET_TRACE.data(), &TsvTrace::GetTraceCb, this);
 	}
 
-	const char *obs_get_name(void *type_data)
+	this->_backend->InitClient();
+}
+
+TsvSendFilter::~TsvSendFilter()
+{
+	TsvInstanceRegistry::GetInstance().Unregister(this);
+	TsvSendScheduler::GetInstance().Unregister(this);
+
+	// Note: Holding the graphics context excludes the render thread, including a send pass that still runs this filter
+	this->_backend->EnterGraphics();
+	this->_render_state = WAITING;
+
+	this->_render_ring.Clear();
+	this->_damage_tracker.Clear();
+	this->_frame_readback.Clear();
+	this->ClearPackTarget();
+	this->ClearDownscaleTiers();
+
+	// Notify receivers that the image is no longer sent
+	if(!this->_tex_name.empty())
+		this->_backend->RevokeImageInfo(this->_tex_name.c_str());
+
+	this->RevokeAliases();
+	this->RevokeCpuFrames();
+
+	this->_source = nullptr;
+
+	this->_backend->LeaveGraphics();
+}
+
+obs_properties_t *TsvSendFilter::GetProperties()
+{
+	obs_properties_t *properties = obs_properties_create();
+
+	obs_properties_add_text(properties, PROPERTY_SHARED_TEXTURE_NAME.data(),
+	                        obs_module_text(PROPERTY_SHARED_TEXTURE_NAME.data()), OBS_TEXT_DEFAULT);
+
+	obs_properties_add_text(properties, PROPERTY_SHARED_TEXTURE_ALIASES.data(),
+	                        obs_module_text(PROPERTY_SHARED_TEXTURE_ALIASES.data()), OBS_TEXT_DEFAULT);
+
+	obs_properties_add_button(properties, PROPERTY_APPLY_BUTTON.data(), obs_module_text(PROPERTY_APPLY_BUTTON.data()),
+	                          &TsvSendFilter::PropertyClickedCb);
+
+	obs_property_t *lazy_send =
+		obs_properties_add_bool(properties, PROPERTY_LAZY_SEND.data(), obs_module_text(PROPERTY_LAZY_SEND.data()));
+	obs_property_set_long_description(lazy_send, obs_module_text(PROPERTY_LAZY_SEND_DESCRIPTION.data()));
+
+	obs_property_t *capture_mode =
+		obs_properties_add_list(properties, PROPERTY_CAPTURE_MODE.data(),
+	                            obs_module_text(PROPERTY_CAPTURE_MODE.data()), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(capture_mode, obs_module_text(PROPERTY_CAPTURE_MODE_FILTER_INPUT.data()),
+	                          CAPTURE_FILTER_INPUT);
+	obs_property_list_add_int(capture_mode, obs_module_text(PROPERTY_CAPTURE_MODE_OFFSCREEN.data()),
+	                          CAPTURE_OFFSCREEN_RENDER);
+	obs_property_set_modified_callback(capture_mode, &TsvSendFilter::CaptureModeModifiedCb);
+
+	obs_properties_add_int(properties, PROPERTY_BUFFER_COUNT.data(), obs_module_text(PROPERTY_BUFFER_COUNT.data()), 1,
+	                       MAX_BUFFER_COUNT, 1);
+
+	obs_property_t *downscale_tiers = obs_properties_add_list(properties, PROPERTY_DOWNSCALE_TIERS.data(),
+	                                                          obs_module_text(PROPERTY_DOWNSCALE_TIERS.data()),
+	                                                          OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(downscale_tiers, obs_module_text(PROPERTY_DOWNSCALE_TIERS_NONE.data()), 0);
+	obs_property_list_add_int(downscale_tiers, obs_module_text(PROPERTY_DOWNSCALE_TIERS_HALF.data()), 1);
+	obs_property_list_add_int(downscale_tiers, obs_module_text(PROPERTY_DOWNSCALE_TIERS_QUARTER.data()), 2);
+
+	obs_properties_add_int(properties, PROPERTY_SEND_RATE.data(), obs_module_text(PROPERTY_SEND_RATE.data()), 0,
+	                       MAX_SEND_RATE, 1);
+
+	obs_property_t *shared_format =
+		obs_properties_add_list(properties, PROPERTY_SHARED_FORMAT.data(),
+	                            obs_module_text(PROPERTY_SHARED_FORMAT.data()), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(shared_format, obs_module_text(PROPERTY_SHARED_FORMAT_RGBA.data()),
+	                          TsvPixelLayout::RGBA);
+	obs_property_list_add_int(shared_format, obs_module_text(PROPERTY_SHARED_FORMAT_NV12.data()),
+	                          TsvPixelLayout::NV12);
+	obs_property_list_add_int(shared_format, obs_module_text(PROPERTY_SHARED_FORMAT_I420.data()),
+	                          TsvPixelLayout::I420);
+	obs_property_list_add_int(shared_format, obs_module_text(PROPERTY_SHARED_FORMAT_R10G10B10A2.data()),
+	                          TsvPixelLayout::R10G10B10A2);
+
+	obs_properties_add_bool(properties, PROPERTY_DAMAGE_TRACKING.data(),
+	                        obs_module_text(PROPERTY_DAMAGE_TRACKING.data()));
+
+	obs_properties_add_bool(properties, PROPERTY_CPU_TRANSPORT.data(), obs_module_text(PROPERTY_CPU_TRANSPORT.data()));
+
+	TsvConversion::AddProperties(properties);
+	TsvTrace::AddProperties(properties);
+	this->_stats.AddProperties(properties, this->_access);
+
+	return properties;
+}
+
+void TsvSendFilter::GetDefaults(obs_data_t *defaults)
+{
+	obs_data_set_default_string(defaults, PROPERTY_SHARED_TEXTURE_NAME.data(),
+	                            obs_module_text(PROPERTY_SHARED_TEXTURE_NAME_DEFAULT.data()));
+	obs_data_set_default_string(defaults, PROPERTY_SHARED_TEXTURE_ALIASES.data(), "");
+	obs_data_set_default_bool(defaults, PROPERTY_LAZY_SEND.data(), false);
+	obs_data_set_default_int(defaults, PROPERTY_CAPTURE_MODE.data(), CAPTURE_FILTER_INPUT);
+	obs_data_set_default_int(defaults, PROPERTY_BUFFER_COUNT.data(), DEFAULT_BUFFER_COUNT);
+	obs_data_set_default_int(defaults, PROPERTY_DOWNSCALE_TIERS.data(), 0);
+	obs_data_set_default_int(defaults, PROPERTY_SEND_RATE.data(), 0);
+	obs_data_set_default_int(defaults, PROPERTY_SHARED_FORMAT.data(), TsvPixelLayout::RGBA);
+	obs_data_set_default_bool(defaults, PROPERTY_DAMAGE_TRACKING.data(), false);
+	obs_data_set_default_bool(defaults, PROPERTY_CPU_TRANSPORT.data(), false);
+	obs_data_set_default_bool(defaults, TsvTrace::PROPERTY_TRACE.data(), false);
+	TsvConversion::GetDefaults(defaults);
+}
+
+void TsvSendFilter::UpdateProperties(obs_data_t *settings)
+{
+	// Only update shared texture name when apply button is pressed.
+	// This prevents creating multiple shared textures when typing in the name text field
+	const auto lock            = std::lock_guard(this->_access);
+	Settings &written_settings = this->_written_settings;
+	written_settings.lazy_send = obs_data_get_bool(settings, PROPERTY_LAZY_SEND.data());
+
+	const long long capture_mode  = obs_data_get_int(settings, PROPERTY_CAPTURE_MODE.data());
+	written_settings.capture_mode =
+		capture_mode == CAPTURE_OFFSCREEN_RENDER ? CAPTURE_OFFSCREEN_RENDER : CAPTURE_FILTER_INPUT;
+
+	const long long buffer_count  = obs_data_get_int(settings, PROPERTY_BUFFER_COUNT.data());
+	written_settings.buffer_count = static_cast<uint32_t>(std::clamp<long long>(buffer_count, 1, MAX_BUFFER_COUNT));
+
+	const long long downscale_tier_count  = obs_data_get_int(settings, PROPERTY_DOWNSCALE_TIERS.data());
+	written_settings.downscale_tier_count = static_cast<uint32_t>(
+		std::clamp<long long>(downscale_tier_count, 0, static_cast<long long>(DOWNSCALE_TIER_SUFFIXES.size())));
+
+	const long long send_rate  = obs_data_get_int(settings, PROPERTY_SEND_RATE.data());
+	written_settings.send_rate = static_cast<uint32_t>(std::clamp<long long>(send_rate, 0, MAX_SEND_RATE));
+
+	const long long shared_layout  = obs_data_get_int(settings, PROPERTY_SHARED_FORMAT.data());
+	written_settings.shared_layout = static_cast<TsvPixelLayout::LAYOUT>(
+		std::clamp<long long>(shared_layout, TsvPixelLayout::RGBA, TsvPixelLayout::MAX_LAYOUT));
+
+	written_settings.damage_tracking = obs_data_get_bool(settings, PROPERTY_DAMAGE_TRACKING.data());
+	written_settings.cpu_transport   = obs_data_get_bool(settings, PROPERTY_CPU_TRANSPORT.data());
+	written_settings.trace           = obs_data_get_bool(settings, TsvTrace::PROPERTY_TRACE.data());
+	written_settings.conversion      = TsvConversion::FromSettings(settings);
+
+	// The source draws itself with its own effect when rendered offscreen. Only flipping (via the projection) and
+	// premultiplying alpha (via the blend state) can be applied to it
+	TsvConversion &conversion = written_settings.conversion;
+	if(written_settings.capture_mode == CAPTURE_OFFSCREEN_RENDER &&
+	   (conversion.linear_color || conversion.swizzle_bgra))
 	{
-		UNUSED_PARAMETER(type_data);
-		return TsvSendFilter::PLUGIN_NAME.data();
+		blog(LOG_WARNING, "[%s] Offscreen rendering of image '%s' ignores %s and %s", PLUGIN_NAME.data(),
+		     written_settings.shared_texture_name.c_str(), TsvConversion::PROPERTY_LINEAR_COLOR.data(),
+		     TsvConversion::PROPERTY_SWIZZLE_BGRA.data());
+		conversion.linear_color = false;
+		conversion.swizzle_bgra = false;
 	}
 
-	void *obs_create(obs_data_t *settings, obs_source_t *source)
+	if(written_settings.trace)
+		TsvTrace::GetInstance().Reserve();
+
+	this->_access.SetTraceImage(PLUGIN_NAME.data(),
+	                            written_settings.trace ? &written_settings.shared_texture_name : nullptr);
+
+	this->_published_settings.Publish(written_settings);
+}
+
+void TsvSendFilter::AdoptSettings()
+{
+	this->_published_settings.Adopt(this->_settings);
+}
+
+void TsvSendFilter::Render(gs_effect_t *effect)
+{
+	UNUSED_PARAMETER(effect);
+
+	// Called from obs_source_video_render() while rendering offscreen. Settings must not change mid frame
+	if(this->_render_state.load(std::memory_order_acquire) == OFFSCREEN_RENDERING)
 	{
-		// Enter graphics to load OpenGL functions
-		obs_enter_graphics();
+		this->_backend->SkipVideoFilter(this->_source);
+		return;
+	}
 
-		TextureShareGlClient::initialize_gl_external();
+	this->AdoptSettings();
+
+	// Input is passed through until the client connected in the background
+	if(!this->_backend->IsClientConnected())
+	{
+		this->_backend->SkipVideoFilter(this->_source);
+		return;
+	}
 
-		void *data = bmalloc(sizeof(TsvSendFilter));
-		new(data) TsvSendFilter(settings, source);
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "Render", this->_tex_name);
 
-		obs_leave_graphics();
-		return data;
+	if(this->_settings->capture_mode == CAPTURE_FILTER_INPUT)
+	{
+		this->CaptureFilterInput();
+		return;
 	}
 
-	void obs_destroy(void *data)
+	// Mark available update for offscreen rendering
+	RENDER_STATE expected = WAITING;
+	this->_render_state.compare_exchange_strong(expected, UPDATE_AVAILABLE, std::memory_order_acq_rel);
+
+	// No filter, only offscreen rendering
+	this->_backend->SkipVideoFilter(this->_source);
+}
+
+void TsvSendFilter::CaptureFilterInput()
+{
+	const uint32_t width  = this->_backend->GetSourceWidth(this->_source);
+	const uint32_t height = this->_backend->GetSourceHeight(this->_source);
+
+	if(this->SkipWithoutConsumer())
 	{
-		if(data)
-		{
-			reinterpret_cast<TsvSendFilter *>(data)->~TsvSendFilter();
-			bfree(data);
-		}
+		this->_stats.Increment(TsvStats::FRAMES_SKIPPED);
+		this->_backend->SkipVideoFilter(this->_source);
+		return;
 	}
 
-	void obs_get_defaults(void *data, obs_data_t *defaults)
+	// Init render target
+	if(!this->PrepareRenderTarget(width, height))
 	{
-		return reinterpret_cast<TsvSendFilter *>(data)->GetDefaults(defaults);
+		this->_backend->SkipVideoFilter(this->_source);
+		return;
 	}
 
-	obs_properties_t *obs_get_properties(void *data)
+	// Publish the newest finished frame before rendering the next one
+	this->PublishReadyFrame();
+
+	// Pass input through unchanged on frames that are not sent
+	if(!this->IsSendFrame())
 	{
-		return reinterpret_cast<TsvSendFilter *>(data)->GetProperties();
+		this->_backend->SkipVideoFilter(this->_source);
+		return;
 	}
 
-	void obs_update(void *data, obs_data_t *settings)
+	// Render filter input once into the render target
+	gs_texrender_t *const render_target = this->_render_ring.AcquireRenderTarget();
+	bool captured                       = false;
 	{
-		return reinterpret_cast<TsvSendFilter *>(data)->UpdateProperties(settings);
+		const TsvStats::ScopedTimer render_timer(this->_stats, TsvStats::RENDER);
+		captured = this->_backend->CaptureFilterInput(this->_source, render_target, width, height,
+		                                              this->_render_ring.GetFormat(), this->_settings->conversion);
 	}
 
-	void obs_video_render(void *data, gs_effect_t *effect)
+	if(!captured)
 	{
-		return reinterpret_cast<TsvSendFilter *>(data)->Render(effect);
+		this->_render_ring.ReleaseRenderTarget();
+		return;
 	}
 
-	void obs_offscreen_render(void *param, uint32_t cx, uint32_t cy)
+	this->SubmitFrame(render_target);
+
+	// Pass captured input on to the next filter. Conversions are undone in the same draw, see GetCaptureFormat()
+	this->_backend->DrawTexture(this->_backend->GetTexrenderTexture(render_target),
+	                            this->_settings->conversion.Inverse());
+}
+
+bool TsvSendFilter::SkipWithoutConsumer()
+{
+	if(!this->_settings->lazy_send)
+		return false;
+
+	// Render once under a new name first. Creates the image, and the synchronization block consumers announce
+	// themselves in, under a name that is revoked again on rename or destroy
+	if(this->_settings->shared_texture_name != this->_tex_name)
+		return false;
+
+	if(this->HasConsumer(this->_tex_name))
+		return false;
+
+	// Keep rendering if only an alias or a downscaled tier is read
+	for(const Alias &alias : this->_aliases)
 	{
-		return reinterpret_cast<TsvSendFilter *>(param)->OffscreenRender(cx, cy);
+		if(this->HasConsumer(alias.name))
+			return false;
 	}
+
+	for(const DownscaleTier &tier : this->_downscale_tiers)
+	{
+		if(this->HasConsumer(tier.name))
+			return false;
+	}
+
+	return true;
 }
 
-TsvSendFilter::TsvSendFilter(obs_data_t *settings, obs_source_t *source)
-	: _source(source)
+bool TsvSendFilter::IsSendFrame()
 {
-	this->UpdateSharedTextureName(settings);
+	const uint64_t frame_index = this->_backend->GetVideoFrameIndex();
+	if(frame_index == this->_last_send_frame)
+		return false;
+
+	const double frame_rate  = this->_backend->GetVideoFrameRate();
+	const uint32_t send_rate = this->_settings->send_rate;
+	if(send_rate > 0 && frame_rate > send_rate)
+	{
+		// Send the first frame at or after the deadline, then move the deadline on by one send interval. Achieves
+		// rates that don't divide the canvas rate on average, e.g. 45 fps sends 3 of 4 frames at 60 fps
+		const uint64_t frame_ns         = this->_backend->GetVideoFrameTime();
+		const uint64_t frame_interval_ns = static_cast<uint64_t>(1e9 / frame_rate);
+		const uint64_t send_interval_ns  = static_cast<uint64_t>(1e9 / send_rate);
+
+		// Restart the schedule if the deadline is more than one send interval off, e.g. after the filter was hidden
+		// or send_rate changed. Keeps a backlog from causing a burst of sends. The first send is delayed by this
+		// filter's phase
+		if(this->_next_send_ns + send_interval_ns <= frame_ns || this->_next_send_ns > frame_ns + send_interval_ns)
+		{
+			const uint64_t phase_frames = this->_send_phase % static_cast<uint64_t>(frame_rate / send_rate);
+			this->_next_send_ns         = frame_ns + phase_frames * frame_interval_ns;
+		}
 
-	obs_add_main_render_callback(obs_offscreen_render, this);
+		// Note: Frame times are rounded to whole ns and jitter slightly. Half a frame of tolerance keeps rates that
+		// divide the canvas rate on exact frames
+		if(frame_ns + frame_interval_ns / 2 < this->_next_send_ns)
+		{
+			this->_stats.Increment(TsvStats::FRAMES_SKIPPED);
+			return false;
+		}
+
+		this->_next_send_ns += send_interval_ns;
+	}
 
-	this->_tex_share_gl.init_with_server_launch();
+	this->_last_send_frame = frame_index;
+	return true;
 }
 
-TsvSendFilter::~TsvSendFilter()
+bool TsvSendFilter::HasConsumer(const std::string &name)
 {
-	// Note: Enter graphics first to prevent race condition
-	obs_enter_graphics();
-	const auto lock     = std::lock_guard(this->_access);
-	this->_render_state = WAITING;
+	return !this->_settings->lazy_send || this->_backend->HasConsumer(name.c_str(), CONSUMER_TIMEOUT);
+}
 
-	obs_remove_main_render_callback(obs_offscreen_render, this);
+void TsvSendFilter::OffscreenRender(uint32_t /*cx*/, uint32_t /*cy*/)
+{
+	if(!this->_backend->IsClientConnected())
+		return;
+
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "OffscreenRender", this->_tex_name);
+
+	// Frames captured in the filter chain are sent here, batched with the sends of the other filters
+	if(this->_settings->capture_mode == CAPTURE_FILTER_INPUT)
+		this->PublishReadyFrame();
+
+	// Wait for update. While OFFSCREEN_RENDERING, this->Render() only skips the filter
+	RENDER_STATE expected = UPDATE_AVAILABLE;
+	if(!this->_render_state.compare_exchange_strong(expected, OFFSCREEN_RENDERING, std::memory_order_acq_rel))
+		return;
+
+	this->AdoptSettings();
+
+	// Input is captured in the filter chain
+	if(this->_settings->capture_mode == CAPTURE_OFFSCREEN_RENDER)
+		this->RenderOffscreenFrame();
 
-	if(this->_render_target)
+	this->_render_state.store(WAITING, std::memory_order_release);
+}
+
+void TsvSendFilter::RenderOffscreenFrame()
+{
+	// Skip rendering while nobody reads the shared image
+	if(this->SkipWithoutConsumer())
 	{
-		obs_enter_graphics();
-		gs_texrender_destroy(this->_render_target);
-		this->_render_target = nullptr;
-		obs_leave_graphics();
+		this->_stats.Increment(TsvStats::FRAMES_SKIPPED);
+		return;
 	}
 
-	this->_source = nullptr;
+	const uint32_t width  = this->_backend->GetSourceWidth(this->_source);
+	const uint32_t height = this->_backend->GetSourceHeight(this->_source);
+
+	// Init offscreen render target
+	if(!this->PrepareRenderTarget(width, height))
+		return;
+
+	// Publish the newest finished frame before rendering the next one
+	this->PublishReadyFrame();
 
-	obs_leave_graphics();
+	if(!this->IsSendFrame())
+		return;
+
+	// Perform offscreen rendering
+	gs_texrender_t *const render_target = this->_render_ring.AcquireRenderTarget();
+	if(this->_backend->BeginTexrender(render_target, width, height))
+	{
+		{
+			const TsvStats::ScopedTimer render_timer(this->_stats, TsvStats::RENDER);
+			this->_backend->RenderSource(this->_source, width, height, this->_settings->conversion);
+			this->_backend->EndTexrender(render_target);
+		}
+
+		this->SubmitFrame(render_target);
+	}
+	else
+		this->_render_ring.ReleaseRenderTarget();
 }
 
-obs_properties_t *TsvSendFilter::GetProperties()
+bool TsvSendFilter::PrepareRenderTarget(uint32_t width, uint32_t height)
 {
-	obs_properties_t *properties = obs_properties_create();
+	const Settings &settings = *this->_settings;
+	const bool aliases_match = std::equal(this->_aliases.begin(), this->_aliases.end(),
+	                                      settings.shared_texture_aliases.begin(), settings.shared_texture_aliases.end(),
+	                                      [](const Alias &alias, const std::string &name) { return alias.name == name; });
+	if(this->_render_ring.GetSize() == settings.buffer_count &&
+	   this->_downscale_tiers.size() == settings.downscale_tier_count && this->_tex_layout == settings.shared_layout &&
+	   width == this->_tex_width && height == this->_tex_height && this->_tex_name == settings.shared_texture_name &&
+	   this->_render_ring.GetFormat() == GetCaptureFormat(settings) && aliases_match)
+		return true;
 
-	obs_properties_add_text(properties, PROPERTY_SHARED_TEXTURE_NAME.data(),
-	                        obs_module_text(PROPERTY_SHARED_TEXTURE_NAME.data()), OBS_TEXT_DEFAULT);
+	return this->UpdateRenderTarget(width, height);
+}
 
-	obs_properties_add_button(properties, PROPERTY_APPLY_BUTTON.data(), obs_module_text(PROPERTY_APPLY_BUTTON.data()),
-	                          &TsvSendFilter::PropertyClickedCb);
+void TsvSendFilter::PublishReadyFrame()
+{
+	if(this->_render_ring.GetSize() <= 1)
+		return;
 
-	return properties;
+	gs_texrender_t *const ready_frame = this->_render_ring.PopReadyFrame();
+	if(ready_frame)
+		this->SendFrame(ready_frame);
 }
 
-void TsvSendFilter::GetDefaults(obs_data_t *defaults)
+void TsvSendFilter::SubmitFrame(gs_texrender_t *render_target)
 {
-	obs_data_set_default_string(defaults, PROPERTY_SHARED_TEXTURE_NAME.data(),
-	                            obs_module_text(PROPERTY_SHARED_TEXTURE_NAME_DEFAULT.data()));
+	if(this->_render_ring.GetSize() > 1)
+	{
+		const size_t slot           = this->_render_ring.GetSlot(render_target);
+		gs_texture_t *const texture = this->_backend->GetTexrenderTexture(render_target);
+
+		// Compare with the previous frame while the ring still holds both. Also drops a stale comparison of the slot
+		gs_texrender_t *const previous =
+			this->_settings->damage_tracking ? this->_render_ring.GetPreviousFrame() : nullptr;
+		this->_damage_tracker.Detect(slot, texture, previous ? this->_backend->GetTexrenderTexture(previous) : nullptr);
+
+		// Queue the CPU copy before fencing, so it finished once the frame is published
+		this->_frame_readback.Stage(slot, this->_settings->cpu_transport ? texture : nullptr);
+
+		// Publish once the GPU finished rendering, see PublishReadyFrame()
+		this->_render_ring.SubmitRenderTarget(this->_backend->GetVideoFrameTime());
+		return;
+	}
+
+	this->SendFrame(render_target);
+	this->_render_ring.ReleaseRenderTarget();
 }
 
-void TsvSendFilter::UpdateProperties(obs_data_t * /*settings*/)
+void TsvSendFilter::SendFrame(gs_texrender_t *render_target)
 {
-	// Do nothing. Only update settings when apply button is pressed.
-	// This prevents creating multiple shared textures when typing in the name text field
+	gs_texture_t *const ptex = this->_backend->GetTexrenderTexture(render_target);
+
+	const FrameInfo frame = this->GetFrameInfo(render_target);
+
+	// Note: The frame is packed at most once and then copied to the shared image and each alias
+	gs_texture_t *packed = nullptr;
+	this->PublishSharedImage(this->_tex_name, this->_sent_sequence, ptex, packed, frame);
+	for(Alias &alias : this->_aliases)
+		this->PublishSharedImage(alias.name, alias.sent_sequence, ptex, packed, frame);
+
+	this->SendDownscaleTiers(ptex, frame);
+	this->SendCpuFrame(render_target, frame.changed);
 }
 
-void TsvSendFilter::Render(gs_effect_t *effect)
+TsvSendFilter::FrameInfo TsvSendFilter::GetFrameInfo(gs_texrender_t *render_target)
 {
-	UNUSED_PARAMETER(effect);
+	FrameInfo frame;
+	frame.damage = TsvImageRect{0, 0, this->_tex_width, this->_tex_height};
 
-	if(this->_render_state != OFFSCREEN_RENDERING)
+	// Unpipelined frames are sent in the video frame they were captured in. They are not compared
+	if(this->_render_ring.GetSize() <= 1)
 	{
-		const auto lock = std::lock_guard(this->_access);
-		// Mark available update for offscreen rendering
-		this->_render_state = UPDATE_AVAILABLE;
+		frame.timestamp_ns = this->_backend->GetVideoFrameTime();
+		return frame;
 	}
 
-	// No filter, only offscreen rendering
-	obs_source_skip_video_filter(this->_source);
+	const size_t slot  = this->_render_ring.GetSlot(render_target);
+	frame.sequence     = this->_render_ring.GetSequence(slot);
+	frame.timestamp_ns = this->_render_ring.GetTimestamp(slot);
+	if(this->_settings->damage_tracking)
+		frame.changed = this->_damage_tracker.GetDamage(slot, frame.damage);
+
+	return frame;
 }
 
-void TsvSendFilter::OffscreenRender(uint32_t /*cx*/, uint32_t /*cy*/)
+void TsvSendFilter::PublishSharedImage(const std::string &name, uint64_t &sent_sequence, gs_texture_t *texture,
+                                       gs_texture_t *&packed, const FrameInfo &frame)
 {
-	// Wait for update
-	if(this->_render_state != UPDATE_AVAILABLE)
+	// Damage is relative to the previously rendered frame. Only usable if the image holds that frame
+	const uint64_t previous_sequence = std::exchange(sent_sequence, frame.sequence);
+	const bool holds_previous = frame.sequence != 0 && previous_sequence != 0 && previous_sequence + 1 == frame.sequence;
+	if(!frame.changed && holds_previous)
+	{
+		this->_stats.Increment(TsvStats::FRAMES_UNCHANGED);
 		return;
+	}
 
-	const auto lock     = std::lock_guard(this->_access);
-	this->_render_state = WAITING;
+	TsvImageRect region = holds_previous ? frame.damage : TsvImageRect{0, 0, this->_tex_width, this->_tex_height};
+	if(this->HasConsumer(name) && this->SendSharedImage(name, texture, packed, region))
+	{
+		// Notify receivers that a new frame is available
+		this->_backend->PublishFrame(name.c_str(), region, frame.timestamp_ns);
+		this->_stats.Increment(TsvStats::FRAMES_SENT);
+
+		if(region.width < this->_packed_width || region.height < this->_packed_height)
+			this->_stats.Increment(TsvStats::FRAMES_PARTIAL);
+	}
+	else
+	{
+		// The image missed this frame, so the next one is sent completely
+		sent_sequence = 0;
+	}
+}
 
-	//	if(!this->_source)
-	//		return;
+void TsvSendFilter::SendCpuFrame(gs_texrender_t *render_target, bool changed)
+{
+	if(!this->_settings->cpu_transport)
+		return this->RevokeCpuFrames();
 
-	const uint32_t width  = obs_source_get_base_width(this->_source);
-	const uint32_t height = obs_source_get_base_height(this->_source);
+	// Frames are only read back if pipelined
+	if(this->_render_ring.GetSize() <= 1)
+		return;
 
-	// Init offscreen render target
-	if(!this->_render_target || width != this->_tex_width || height != this->_tex_height)
+	const size_t slot           = this->_render_ring.GetSlot(render_target);
+	const uint64_t sequence     = this->_render_ring.GetSequence(slot);
+	const uint64_t cpu_sequence = std::exchange(this->_cpu_sequence, 0);
+
+	// Unchanged frames are identical to the previously rendered one. Nothing to write if the ring already holds it
+	if(!changed && cpu_sequence != 0 && cpu_sequence + 1 == sequence)
 	{
-		if(!this->UpdateRenderTarget(width, height))
-			return;
+		this->_cpu_sequence = sequence;
+		return;
 	}
 
-	// Perform offscreen rendering
-	gs_texrender_reset(this->_render_target);
-	if(gs_texrender_begin(this->_render_target, width, height))
+	const uint8_t *data = nullptr;
+	uint32_t linesize   = 0;
+	if(!this->HasConsumer(this->_tex_name) || !this->_frame_readback.Map(slot, data, linesize))
+		return;
+
+	bool written = false;
 	{
-		// obs_source_video_render() calls this->Render(). This prevents a deadlock
-		this->_render_state = OFFSCREEN_RENDERING;
+		const TsvStats::ScopedTimer write_timer(this->_stats, TsvStats::WRITE_CPU_FRAME);
+		written = this->_backend->WriteCpuFrame(this->_tex_name.c_str(), data, this->_frame_readback.GetWidth(),
+		                                        this->_frame_readback.GetHeight(), linesize,
+		                                        this->_frame_readback.GetFormat());
+	}
+
+	this->_frame_readback.Unmap(slot);
+
+	if(written)
+	{
+		this->_cpu_sequence         = sequence;
+		this->_cpu_frames_published = true;
+	}
+}
+
+void TsvSendFilter::RevokeCpuFrames()
+{
+	if(!this->_cpu_frames_published)
+		return;
+
+	this->_backend->RevokeCpuFrames(this->_tex_name.c_str());
+	this->_cpu_frames_published = false;
+	this->_cpu_sequence         = 0;
+}
+
+bool TsvSendFilter::SendImage(const std::string &name, gs_texture_t *texture, const TsvImageRect &region)
+{
+	const TsvStats::ScopedTimer send_timer(this->_stats, TsvStats::SEND_IMAGE);
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "send_image", name);
+	return this->_backend->SendImage(name.c_str(), texture, region);
+}
+
+bool TsvSendFilter::SendSharedImage(const std::string &name, gs_texture_t *texture, gs_texture_t *&packed,
+                                    TsvImageRect &region)
+{
+	if(this->_tex_layout == TsvPixelLayout::RGBA)
+		return this->SendImage(name, texture, region);
+
+	if(!packed)
+	{
+		if(!this->_backend->PackTexture(texture, this->_pack_target, this->_tex_layout, this->_tex_width,
+		                                this->_tex_height))
+			return false;
 
-		struct vec4 background;
-		vec4_zero(&background);
-		background.x = 1.0f;
+		packed = this->_backend->GetTexrenderTexture(this->_pack_target);
+	}
 
-		gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
-		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+	region = TsvImageRect{0, 0, this->_packed_width, this->_packed_height};
+	return this->SendImage(name, packed, region);
+}
 
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+void TsvSendFilter::SendDownscaleTiers(gs_texture_t *texture, const FrameInfo &frame)
+{
+	// Only downscale as far as the smallest tier that is read
+	size_t tier_count = this->_downscale_tiers.size();
+	while(tier_count > 0 && !this->HasConsumer(this->_downscale_tiers[tier_count - 1].name))
+		--tier_count;
+
+	// Unchanged frames are only needed by tiers that missed a previous frame
+	const auto tiers_end = this->_downscale_tiers.begin() + tier_count;
+	if(!frame.changed && std::all_of(this->_downscale_tiers.begin(), tiers_end, [this](const DownscaleTier &tier) {
+		   return tier.current || !this->HasConsumer(tier.name);
+	   }))
+		return;
 
-		obs_source_video_render(this->_source);
+	gs_texture_t *source = texture;
+	for(size_t i = 0; i < this->_downscale_tiers.size(); ++i)
+	{
+		DownscaleTier &tier = this->_downscale_tiers[i];
+		tier.current        = false;
+		if(i >= tier_count || !source)
+			continue;
 
-		gs_blend_state_pop();
-		gs_texrender_end(this->_render_target);
+		if(!tier.texrender)
+			tier.texrender = this->_backend->CreateTexrender(tier.width, tier.height, GS_RGBA);
 
-		this->_render_state = WAITING;
+		if(!this->_backend->DownscaleTexture(source, tier.texrender, tier.width, tier.height))
+		{
+			source = nullptr;
+			continue;
+		}
 
-		// Send to shared texture
-		gs_texture_t *const ptex = gs_texrender_get_texture(this->_render_target);
-		GLuint *const gl_texture = reinterpret_cast<GLuint *>(gs_texture_get_obj(ptex));
-		if(gl_texture)
+		source = this->_backend->GetTexrenderTexture(tier.texrender);
+
+		const TsvImageRect region{0, 0, tier.width, tier.height};
+		if(this->HasConsumer(tier.name) && this->SendImage(tier.name, source, region))
 		{
-			// Texture size
-			const GlImageExtent image_size{
-				{0,              0              },
-				{(GLsizei)width, (GLsizei)height},
-			};
-
-			// Send texture
-			GLint drawFboId = 0;
-			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFboId);
-
-			this->_tex_share_gl.send_image(this->_shared_texture_name.c_str(), *gl_texture, GL_TEXTURE_2D, false,
-			                               drawFboId, &image_size);
+			this->_backend->PublishFrame(tier.name.c_str(), region, frame.timestamp_ns);
+			tier.current = true;
 		}
 	}
 }
@@ -242,49 +672,256 @@ bool TsvSendFilter::UpdateRenderTarget(uint32_t width, uint32_t height)
 	if(width == 0 || height == 0)
 		return false;
 
-	obs_enter_graphics();
+	const TsvTrace::ScopedEvent trace(this->_settings->trace, PLUGIN_NAME.data(), "UpdateRenderTarget",
+	                                  this->_tex_name);
+	this->_stats.Increment(TsvStats::RESIZES);
+
+	const Settings &settings             = *this->_settings;
+	const TsvPixelLayout::LAYOUT layout  = settings.shared_layout;
+	const gs_color_format capture_format = GetCaptureFormat(settings);
+
+	// Note: Only images whose name, size or layout changed are initialized again. Receivers of the others keep reading
+	// them without reinitializing their textures
+	const bool resized    = width != this->_tex_width || height != this->_tex_height || layout != this->_tex_layout;
+	const bool reset_ring = resized || this->_render_ring.GetSize() != settings.buffer_count ||
+	                        this->_render_ring.GetFormat() != capture_format;
+
+	// Frames that finished rendering at the previous size are still published before the ring is dropped
+	if(reset_ring)
+		this->PublishReadyFrame();
+
+	// Notify receivers of the previous name that the image is no longer sent
+	const bool renamed = this->_tex_name != settings.shared_texture_name;
+	if(renamed)
+	{
+		this->ClearDownscaleTiers();
+
+		if(!this->_tex_name.empty())
+			this->_backend->RevokeImageInfo(this->_tex_name.c_str());
+
+		this->RevokeCpuFrames();
+
+		this->_tex_name = settings.shared_texture_name;
+	}
+
+	// Drop frames rendered at the previous size
+	if(reset_ring)
+	{
+		this->_render_ring.Resize(settings.buffer_count, width, height, capture_format);
+		this->_damage_tracker.Resize(settings.buffer_count, width, height);
+		this->_frame_readback.Resize(settings.buffer_count, width, height, capture_format);
+		this->_cpu_sequence = 0;
+	}
+
+	if(reset_ring || renamed)
+		this->_sent_sequence = 0;
 
-	if(!this->_render_target)
-		this->_render_target = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	// Packed layouts are stored in a differently sized R8G8B8A8 image
+	uint32_t packed_width, packed_height;
+	TsvPixelLayout::GetPackedSize(layout, width, height, packed_width, packed_height);
+
+	if(resized)
+	{
+		this->ClearPackTarget();
+		if(layout != TsvPixelLayout::RGBA)
+			this->_pack_target = this->_backend->CreateTexrender(packed_width, packed_height, GS_RGBA);
+	}
 
 	// Initialize image. (OBS's GS_BGRA should translate to OpenGL's GL_BGRA)
-	this->_tex_share_gl.init_image(this->_shared_texture_name.c_str(), width, height, ImgFormat::R8G8B8A8, true);
+	if(resized || renamed)
+	{
+		this->_backend->InitImage(this->_tex_name.c_str(), packed_width, packed_height, ImgFormat::R8G8B8A8, true);
+		this->_backend->PublishImageInfo(this->_tex_name.c_str(), width, height, ImgFormat::R8G8B8A8, layout);
+	}
 
-	this->_tex_width  = width;
-	this->_tex_height = height;
+	// Notify receivers of removed aliases. Remaining aliases keep their image and, if the ring is kept, their frame
+	this->RevokeAliases(settings.shared_texture_aliases);
+	std::vector<Alias> aliases;
+	for(const std::string &alias_name : settings.shared_texture_aliases)
+	{
+		const auto existing = std::find_if(this->_aliases.begin(), this->_aliases.end(),
+		                                   [&alias_name](const Alias &alias) { return alias.name == alias_name; });
+		const bool added    = existing == this->_aliases.end();
+		aliases.push_back(added || reset_ring ? Alias{alias_name} : *existing);
 
-	obs_leave_graphics();
+		if(!added && !resized)
+			continue;
+
+		this->_backend->InitImage(alias_name.c_str(), packed_width, packed_height, ImgFormat::R8G8B8A8, true);
+		this->_backend->PublishImageInfo(alias_name.c_str(), width, height, ImgFormat::R8G8B8A8, layout);
+	}
+
+	this->_aliases = std::move(aliases);
+
+	this->UpdateDownscaleTiers(width, height);
+
+	this->_tex_width     = width;
+	this->_tex_height    = height;
+	this->_tex_layout    = layout;
+	this->_packed_width  = packed_width;
+	this->_packed_height = packed_height;
 
 	return true;
 }
 
+void TsvSendFilter::UpdateDownscaleTiers(uint32_t width, uint32_t height)
+{
+	// Tiers beyond the new count are no longer sent
+	const size_t tier_count = this->_settings->downscale_tier_count;
+	while(this->_downscale_tiers.size() > tier_count)
+	{
+		this->ReleaseDownscaleTier(this->_downscale_tiers.back());
+		this->_downscale_tiers.pop_back();
+	}
+
+	this->_downscale_tiers.resize(tier_count);
+	for(size_t i = 0; i < tier_count; ++i)
+	{
+		DownscaleTier &tier         = this->_downscale_tiers[i];
+		const std::string tier_name = this->_tex_name + DOWNSCALE_TIER_SUFFIXES[i].data();
+		const uint32_t tier_width   = std::max<uint32_t>(width >> (i + 1), 1);
+		const uint32_t tier_height  = std::max<uint32_t>(height >> (i + 1), 1);
+
+		// Unchanged tiers keep their image
+		if(tier.name == tier_name && tier.width == tier_width && tier.height == tier_height)
+			continue;
+
+		if(tier.texrender)
+			this->_backend->DestroyTexrender(tier.texrender);
+
+		tier = DownscaleTier{tier_name, nullptr, tier_width, tier_height};
+
+		this->_backend->InitImage(tier.name.c_str(), tier.width, tier.height, ImgFormat::R8G8B8A8, true);
+		this->_backend->PublishImageInfo(tier.name.c_str(), tier.width, tier.height, ImgFormat::R8G8B8A8,
+		                                 TsvPixelLayout::RGBA);
+	}
+}
+
+void TsvSendFilter::ClearDownscaleTiers()
+{
+	for(DownscaleTier &tier : this->_downscale_tiers)
+		this->ReleaseDownscaleTier(tier);
+
+	this->_downscale_tiers.clear();
+}
+
+void TsvSendFilter::ReleaseDownscaleTier(DownscaleTier &tier)
+{
+	if(tier.texrender)
+		this->_backend->DestroyTexrender(tier.texrender);
+
+	tier.texrender = nullptr;
+	this->_backend->RevokeImageInfo(tier.name.c_str());
+}
+
+void TsvSendFilter::ClearPackTarget()
+{
+	if(!this->_pack_target)
+		return;
+
+	this->_backend->DestroyTexrender(this->_pack_target);
+	this->_pack_target = nullptr;
+}
+
+void TsvSendFilter::RevokeAliases(const std::vector<std::string> &names)
+{
+	for(const Alias &alias : this->_aliases)
+	{
+		if(std::find(names.begin(), names.end(), alias.name) == names.end())
+			this->_backend->RevokeImageInfo(alias.name.c_str());
+	}
+}
+
+std::vector<std::string> TsvSendFilter::ParseAliases(const char *aliases, const std::string &shared_texture_name)
+{
+	std::vector<std::string> names;
+
+	const std::string_view list = aliases ? aliases : "";
+	size_t begin                = 0;
+	while(begin <= list.size())
+	{
+		const size_t end = std::min(list.find(',', begin), list.size());
+
+		// Trim surrounding whitespace
+		std::string_view name = list.substr(begin, end - begin);
+		while(!name.empty() && std::isspace(static_cast<unsigned char>(name.front())))
+			name.remove_prefix(1);
+		while(!name.empty() && std::isspace(static_cast<unsigned char>(name.back())))
+			name.remove_suffix(1);
+
+		if(!name.empty() && name != shared_texture_name && std::find(names.begin(), names.end(), name) == names.end())
+			names.emplace_back(name);
+
+		begin = end + 1;
+	}
+
+	return names;
+}
+
+gs_color_format TsvSendFilter::GetCaptureFormat(const Settings &settings)
+{
+	if(settings.shared_layout == TsvPixelLayout::R10G10B10A2)
+		return GS_RGBA16F;
+
+	// Note: At 8 bits, dark colors converted to linear ones and colors of translucent pixels multiplied with alpha
+	// don't survive the round trip back to the filter input
+	const TsvConversion &conversion = settings.conversion;
+	if(settings.capture_mode == CAPTURE_FILTER_INPUT && (conversion.linear_color || conversion.premultiply_alpha))
+		return GS_RGBA16F;
+
+	return GS_RGBA;
+}
+
 void TsvSendFilter::UpdateSharedTextureName(obs_data_t *settings)
 {
-	// Check if sender name was updated
+	// Check if sender name or aliases were updated
 	const char *new_sender_name = obs_data_get_string(settings, PROPERTY_SHARED_TEXTURE_NAME.data());
-	if(this->_shared_texture_name != new_sender_name)
-	{
-		// If name was updated, reinitialize render target
-		// Note: Enter graphics first to prevent race condition
-		obs_enter_graphics();
-		const auto lock = std::lock_guard(this->_access);
-		if(this->_render_target)
-		{
-			gs_texrender_destroy(this->_render_target);
-			this->_render_target = nullptr;
-		}
+	std::vector<std::string> new_aliases =
+		ParseAliases(obs_data_get_string(settings, PROPERTY_SHARED_TEXTURE_ALIASES.data()), new_sender_name);
+
+	const auto lock = std::lock_guard(this->_access);
+	if(this->_written_settings.shared_texture_name == new_sender_name &&
+	   this->_written_settings.shared_texture_aliases == new_aliases)
+		return;
 
-		obs_leave_graphics();
+	// The render thread reinitializes the render targets under the new names with its next frame
+	this->_written_settings.shared_texture_name    = new_sender_name;
+	this->_written_settings.shared_texture_aliases = std::move(new_aliases);
+	this->_published_settings.Publish(this->_written_settings);
 
-		this->_shared_texture_name = obs_data_get_string(settings, PROPERTY_SHARED_TEXTURE_NAME.data());
+	// Two filters sending to the same image overwrite each other's frames
+	TsvInstanceRegistry &registry = TsvInstanceRegistry::GetInstance();
+	if(registry.Register(this, new_sender_name, TsvInstanceRegistry::PUBLISHER) > 0)
+		blog(LOG_WARNING, "[%s] Image '%s' is already sent by another filter", PLUGIN_NAME.data(), new_sender_name);
+
+	for(const std::string &alias_name : this->_written_settings.shared_texture_aliases)
+	{
+		if(registry.Add(this, alias_name, TsvInstanceRegistry::PUBLISHER) > 0)
+			blog(LOG_WARNING, "[%s] Image '%s' is already sent by another filter", PLUGIN_NAME.data(),
+			     alias_name.c_str());
 	}
 }
 
+void TsvSendFilter::GetStatsCb(void *data, calldata_t *cd)
+{
+	const TsvSendFilter *const filter = reinterpret_cast<TsvSendFilter *>(data);
+	calldata_set_string(cd, "stats", filter->_stats.ToJson(filter->_access).c_str());
+}
+
 bool TsvSendFilter::PropertyClickedCb(obs_properties_t *props, obs_property_t *property, void *data)
 {
 	return reinterpret_cast<TsvSendFilter *>(data)->PropertyClicked(props, property);
 }
 
+bool TsvSendFilter::CaptureModeModifiedCb(obs_properties_t *props, obs_property_t * /*property*/,
+                                          obs_data_t *settings)
+{
+	const bool offscreen = obs_data_get_int(settings, PROPERTY_CAPTURE_MODE.data()) == CAPTURE_OFFSCREEN_RENDER;
+	obs_property_set_visible(obs_properties_get(props, TsvConversion::PROPERTY_LINEAR_COLOR.data()), !offscreen);
+	obs_property_set_visible(obs_properties_get(props, TsvConversion::PROPERTY_SWIZZLE_BGRA.data()), !offscreen);
+	return true;
+}
+
 bool TsvSendFilter::PropertyClicked(obs_properties_t * /*props*/, obs_property_t * /*property*/)
 {
 	obs_data_t *settings = obs_source_get_settings(this->_source);
@@ -1,13 +1,30 @@
 #pragma once
 
+#include "tsv_backend.hpp"
+#include "tsv_damage_tracker.hpp"
+#include "tsv_frame_readback.hpp"
+#include "tsv_mutex.hpp"
+#include "tsv_render_ring.hpp"
+#include "tsv_snapshot.hpp"
+#include "tsv_stats.hpp"
+
 #include <obs-module.h>
 // #include <obs/graphics/graphics.h>
 #include <texture_share_gl/texture_share_gl_client.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <string_view>
+#include <vector>
 
-/*! \brief Texture sharing filter. Uses offscreen rendering to send source texture to other programs.
+/*! \brief Texture sharing filter. Sends the frames of the source it is attached to to other programs. By default, the
+ * filter input is captured while the filter chain renders and then passed on to the next filter. Alternatively, the
+ * source is rendered offscreen by a main render callback. Captured frames are kept in a render ring and sent once the
+ * GPU finished them, where possible batched with the sends of the other filters by TsvSendScheduler
  */
 class TsvSendFilter
 {
@@ -15,9 +32,51 @@ class TsvSendFilter
 	static constexpr std::string_view PLUGIN_NAME                          = "texture-share-vk-filter-plugin";
 	static constexpr std::string_view PROPERTY_SHARED_TEXTURE_NAME         = "shared_texture_name";
 	static constexpr std::string_view PROPERTY_SHARED_TEXTURE_NAME_DEFAULT = "obs_shared";
+	static constexpr std::string_view PROPERTY_SHARED_TEXTURE_ALIASES      = "shared_texture_aliases";
 	static constexpr std::string_view PROPERTY_APPLY_BUTTON                = "apply";
+	static constexpr std::string_view PROPERTY_LAZY_SEND                   = "lazy_send";
+	static constexpr std::string_view PROPERTY_LAZY_SEND_DESCRIPTION       = "lazy_send_description";
+	static constexpr std::string_view PROPERTY_CAPTURE_MODE                = "capture_mode";
+	static constexpr std::string_view PROPERTY_CAPTURE_MODE_FILTER_INPUT   = "capture_mode_filter_input";
+	static constexpr std::string_view PROPERTY_CAPTURE_MODE_OFFSCREEN      = "capture_mode_offscreen";
+	static constexpr std::string_view PROPERTY_BUFFER_COUNT                = "buffer_count";
+	static constexpr std::string_view PROPERTY_DOWNSCALE_TIERS             = "downscale_tiers";
+	static constexpr std::string_view PROPERTY_DOWNSCALE_TIERS_NONE        = "downscale_tiers_none";
+	static constexpr std::string_view PROPERTY_DOWNSCALE_TIERS_HALF        = "downscale_tiers_half";
+	static constexpr std::string_view PROPERTY_DOWNSCALE_TIERS_QUARTER     = "downscale_tiers_quarter";
+	static constexpr std::string_view PROPERTY_SEND_RATE                   = "send_rate";
+	static constexpr std::string_view PROPERTY_SHARED_FORMAT               = "shared_format";
+	static constexpr std::string_view PROPERTY_SHARED_FORMAT_RGBA          = "shared_format_rgba";
+	static constexpr std::string_view PROPERTY_SHARED_FORMAT_NV12          = "shared_format_nv12";
+	static constexpr std::string_view PROPERTY_SHARED_FORMAT_I420          = "shared_format_i420";
+	static constexpr std::string_view PROPERTY_SHARED_FORMAT_R10G10B10A2   = "shared_format_r10g10b10a2";
+	static constexpr std::string_view PROPERTY_DAMAGE_TRACKING             = "damage_tracking";
+	static constexpr std::string_view PROPERTY_CPU_TRANSPORT               = "cpu_transport";
+
+	// Upper bound of the send_rate property (in frames per second). A send rate of 0 sends every frame
+	static constexpr uint32_t MAX_SEND_RATE = 240;
+
+	// Name suffixes of the downscaled tiers. Tier i is published at 1/2^(i+1) of the full resolution
+	static constexpr std::array<std::string_view, 2> DOWNSCALE_TIER_SUFFIXES = {"@half", "@quarter"};
+
+	// Number of render targets. With more than one, a frame is only published once the GPU finished rendering it
+	static constexpr uint32_t DEFAULT_BUFFER_COUNT = 3;
+	static constexpr uint32_t MAX_BUFFER_COUNT     = 8;
+
+	/*! \brief How the filter obtains the image it shares
+	 */
+	enum CAPTURE_MODE
+	{
+		// Capture the filter's input inside the filter chain and pass it through. Costs one copy
+		CAPTURE_FILTER_INPUT,
+		// Skip the filter and render the parent source a second time from a main render callback
+		CAPTURE_OFFSCREEN_RENDER,
+	};
+
+	// Time without consumer announcement after which lazy sending suspends offscreen rendering
+	static constexpr std::chrono::seconds CONSUMER_TIMEOUT{2};
 
-	TsvSendFilter(obs_data_t *settings, obs_source_t *source);
+	TsvSendFilter(obs_data_t *settings, obs_source_t *source, std::unique_ptr<TsvBackend> backend);
 	~TsvSendFilter();
 
 	obs_properties_t *GetProperties();
@@ -26,18 +85,36 @@ class TsvSendFilter
 	 */
 	void GetDefaults(obs_data_t *defaults);
 
-	/*! \brief Update settings
+	/*! \brief Update settings. The shared texture name and aliases are only updated when the apply button is pressed.
+	 * The render thread picks up the new settings with its next frame
 	 */
 	void UpdateProperties(obs_data_t *settings);
 
-	/*! \brief Renders texture (in separate thread?). Waits for filter notification that more data is available
+	/*! \brief Called by TsvSendScheduler once per video frame. Renders the source offscreen if Render() notified that
+	 * more data is available, and sends frames that finished rendering
 	 */
 	void OffscreenRender(uint32_t cx, uint32_t cy);
 
-	/*! \brief Filter update. Only notifies offscreen renderer that new information is available
+	/*! \brief Filter update. Captures and shares the filter input, or notifies offscreen renderer that new
+	 * information is available, depending on the capture mode
 	 */
 	void Render(gs_effect_t *effect);
 
+	/*! \brief Access mutex, serializes settings updates. Not taken on the render thread. Exposed for lock hold time
+	 * measurements
+	 */
+	const TsvMutex &GetAccessMutex() const
+	{
+		return this->_access;
+	}
+
+	/*! \brief Performance counters. Also available via the get_stats proc handler
+	 */
+	const TsvStats &GetStats() const
+	{
+		return this->_stats;
+	}
+
 	private:
 	enum RENDER_STATE
 	{
@@ -46,26 +123,258 @@ class TsvSendFilter
 		OFFSCREEN_RENDERING
 	};
 
-	RENDER_STATE _render_state = WAITING;
-	bool _update_available     = false;
-	std::mutex _access;
+	/*! \brief Downscaled copy of the shared image, published under a derived name
+	 */
+	struct DownscaleTier
+	{
+		std::string name;
+		gs_texrender_t *texrender = nullptr;
+		uint32_t width            = 0;
+		uint32_t height           = 0;
 
-	TextureShareGlClient _tex_share_gl;
-	std::string _shared_texture_name = "gd_img";
+		// Whether the tier holds the last sent frame
+		bool current = false;
+	};
 
-	obs_source_t *_source          = nullptr;
-	gs_texrender_t *_render_target = nullptr;
+	/*! \brief Additional name the shared image is published under. Receives the same frames as the shared image
+	 */
+	struct Alias
+	{
+		std::string name;
 
-	uint32_t _tex_width  = 0;
-	uint32_t _tex_height = 0;
+		// Ring sequence number of the frame the alias currently holds. 0 if unknown
+		uint64_t sent_sequence = 0;
+	};
+
+	/*! \brief Frame passed from SendFrame() to the images it is published to
+	 */
+	struct FrameInfo
+	{
+		// Ring sequence number. 0 if frames are not pipelined
+		uint64_t sequence = 0;
+
+		// Video frame time the frame was captured in
+		uint64_t timestamp_ns = 0;
+
+		// Whether the frame differs from the previously rendered one, and the region that changed
+		bool changed = true;
+		TsvImageRect damage;
+	};
 
-	/*! \brief (Re-)initialize render target for offscreen rendering
+	/*! \brief Settings used by the render thread. Written on the UI thread and handed over as immutable snapshot
+	 */
+	struct Settings
+	{
+		std::string shared_texture_name;
+
+		// Additional names the shared image is published under. Neither empty nor equal to shared_texture_name
+		std::vector<std::string> shared_texture_aliases;
+
+		// Only render and send while a consumer is attached to the shared image
+		bool lazy_send = false;
+
+		CAPTURE_MODE capture_mode = CAPTURE_FILTER_INPUT;
+		uint32_t buffer_count     = DEFAULT_BUFFER_COUNT;
+
+		// Number of downscaled tiers to publish, at most DOWNSCALE_TIER_SUFFIXES.size()
+		uint32_t downscale_tier_count = 0;
+
+		// Target frames per second. 0: Send every frame
+		uint32_t send_rate = 0;
+
+		// Pixel layout of the shared image. Downscaled tiers are always sent as RGBA
+		TsvPixelLayout::LAYOUT shared_layout = TsvPixelLayout::RGBA;
+
+		// Compare each frame with the previous one and only send the changed region
+		bool damage_tracking = false;
+
+		// Record trace events, see TsvTrace
+		bool trace = false;
+
+		// Additionally read frames back and publish them in a shared memory frame ring
+		bool cpu_transport = false;
+
+		// Applied while capturing. Offscreen rendering only flips and premultiplies alpha, so linear_color and
+		// swizzle_bgra are cleared for it
+		TsvConversion conversion;
+	};
+
+	// Render() moves WAITING to UPDATE_AVAILABLE, OffscreenRender() moves UPDATE_AVAILABLE to OFFSCREEN_RENDERING and
+	// back to WAITING once done
+	std::atomic<RENDER_STATE> _render_state = WAITING;
+
+	// Offset (in video frames) of this filter's send frames. Spreads the sends of multiple filters across frames
+	uint32_t _send_phase = 0;
+
+	// Video frame index of the last captured frame
+	uint64_t _last_send_frame = UINT64_MAX;
+
+	// Video frame time (in ns) from which on the next frame is sent when limited by send_rate. 0: Not scheduled yet
+	uint64_t _next_send_ns = 0;
+	TsvMutex _access;
+	TsvStats _stats;
+
+	// Settings most recently written by the UI thread. Guarded by _access
+	Settings _written_settings;
+	TsvSnapshot<Settings> _published_settings;
+
+	// Settings snapshot of the render thread. Replaced at the start of a frame, see AdoptSettings()
+	std::unique_ptr<const Settings> _settings;
+
+	std::unique_ptr<TsvBackend> _backend;
+
+	obs_source_t *_source = nullptr;
+	TsvRenderRing _render_ring;
+	TsvDamageTracker _damage_tracker;
+	TsvFrameReadback _frame_readback;
+
+	// Ring sequence number of the frame the shared image currently holds. 0 if unknown
+	uint64_t _sent_sequence = 0;
+
+	// Ring sequence number of the frame last written to the CPU frame ring. 0 if unknown
+	uint64_t _cpu_sequence = 0;
+
+	// Whether the CPU frame ring of _tex_name was written since it was last revoked
+	bool _cpu_frames_published = false;
+
+	// Name, size and layout the shared image, render targets and tiers were set up for
+	std::string _tex_name;
+	uint32_t _tex_width                = 0;
+	uint32_t _tex_height               = 0;
+	TsvPixelLayout::LAYOUT _tex_layout = TsvPixelLayout::RGBA;
+
+	// Render target the shared image is packed into. Only used for layouts other than RGBA
+	gs_texrender_t *_pack_target = nullptr;
+	uint32_t _packed_width       = 0;
+	uint32_t _packed_height      = 0;
+
+	std::vector<DownscaleTier> _downscale_tiers;
+
+	// Aliases the shared image was set up for
+	std::vector<Alias> _aliases;
+
+	/*! \brief Switch to the newest published settings. Only called at the start of a frame, so the settings don't
+	 * change while it is rendered
+	 */
+	void AdoptSettings();
+
+	/*! \brief Render the parent source into a render target and send it
+	 */
+	void RenderOffscreenFrame();
+
+	/*! \brief Capture filter input into render target, send it and pass it through
+	 */
+	void CaptureFilterInput();
+
+	/*! \brief Whether sending should be skipped because nobody reads the shared image
+	 */
+	bool SkipWithoutConsumer();
+
+	/*! \brief Whether the current video frame should be captured and sent. Applies the send rate, and makes sure a
+	 * frame is only captured once even if the filter is rendered multiple times per frame
+	 */
+	bool IsSendFrame();
+
+	/*! \brief Reinitialize render targets if name, aliases, size, buffer count or pixel layout changed
+	 */
+	bool PrepareRenderTarget(uint32_t width, uint32_t height);
+
+	/*! \brief Send the newest frame the GPU finished rendering. Only used if frames are pipelined
+	 */
+	void PublishReadyFrame();
+
+	/*! \brief Hand a rendered frame over for publishing. Sends immediately if frames are not pipelined
+	 */
+	void SubmitFrame(gs_texrender_t *render_target);
+
+	/*! \brief Send render target to shared image and its aliases and advance their frame generation. Frames that didn't
+	 * change are not sent
+	 */
+	void SendFrame(gs_texrender_t *render_target);
+
+	/*! \brief Get sequence number, capture time and damage of the frame in render_target. Without damage tracking, the
+	 * whole frame is considered changed
+	 */
+	FrameInfo GetFrameInfo(gs_texrender_t *render_target);
+
+	/*! \brief Send the frame to the named image, unless it already holds an identical frame. Only sends the damaged
+	 * region if the image holds the previously rendered frame. sent_sequence tracks the frame the image holds, packed
+	 * caches the packed frame across calls
+	 */
+	void PublishSharedImage(const std::string &name, uint64_t &sent_sequence, gs_texture_t *texture,
+	                        gs_texture_t *&packed, const FrameInfo &frame);
+
+	/*! \brief Write the read back copy of render_target to the CPU frame ring. Skipped if the ring already holds an
+	 * identical frame. Revokes the ring once the CPU transport was disabled
+	 */
+	void SendCpuFrame(gs_texrender_t *render_target, bool changed);
+
+	/*! \brief Remove the CPU frame ring of the shared image if it was written
+	 */
+	void RevokeCpuFrames();
+
+	/*! \brief Send region of texture to the named image and record the send duration
+	 */
+	bool SendImage(const std::string &name, gs_texture_t *texture, const TsvImageRect &region);
+
+	/*! \brief Send region of texture to the named image, packed into the shared pixel layout. Packed layouts are
+	 * always sent completely, region is set to the sent region of the image. Texture is only packed if packed is null
+	 */
+	bool SendSharedImage(const std::string &name, gs_texture_t *texture, gs_texture_t *&packed, TsvImageRect &region);
+
+	/*! \brief Downscale texture into each tier and send the tiers. Each tier is downscaled from the previous one. If
+	 * the frame didn't change, only tiers that missed a previous frame are sent
+	 */
+	void SendDownscaleTiers(gs_texture_t *texture, const FrameInfo &frame);
+
+	/*! \brief Whether the named image should be sent. Always true unless sending lazily
+	 */
+	bool HasConsumer(const std::string &name);
+
+	/*! \brief (Re-)create downscaled tiers for the given full resolution. Tiers whose name and size didn't change are
+	 * kept. Requires graphics context
+	 */
+	void UpdateDownscaleTiers(uint32_t width, uint32_t height);
+
+	/*! \brief Release downscaled tiers and notify their receivers. Requires graphics context
+	 */
+	void ClearDownscaleTiers();
+
+	/*! \brief Release a downscaled tier's render target and notify its receivers. Requires graphics context
+	 */
+	void ReleaseDownscaleTier(DownscaleTier &tier);
+
+	/*! \brief (Re-)initialize render target and shared image. Revokes the previously shared image if it was renamed.
+	 * Images that keep their name and size are not initialized again
 	 */
 	bool UpdateRenderTarget(uint32_t cx, uint32_t cy);
 
+	/*! \brief Release pack render target. Requires graphics context
+	 */
+	void ClearPackTarget();
+
+	/*! \brief Notify receivers of all aliases that are not in names that the image is no longer sent under them
+	 */
+	void RevokeAliases(const std::vector<std::string> &names = {});
+
+	/*! \brief Split a comma separated alias list. Drops empty names, duplicates and the shared texture name
+	 */
+	static std::vector<std::string> ParseAliases(const char *aliases, const std::string &shared_texture_name);
+
+	/*! \brief Format frames are captured in. 10-bit layouts are captured at 16 bits per channel to keep their
+	 * precision, as are filter inputs whose linear color or alpha conversion is undone when passing them on
+	 */
+	static gs_color_format GetCaptureFormat(const Settings &settings);
+
 	void UpdateSharedTextureName(obs_data_t *settings);
 
+	static void GetStatsCb(void *data, calldata_t *cd);
+
 	static bool PropertyClickedCb(obs_properties_t *props, obs_property_t *property, void *data);
 
+	/*! \brief Hide the conversions offscreen rendering can't apply while it is selected
+	 */
+	static bool CaptureModeModifiedCb(obs_properties_t *props, obs_property_t *property, obs_data_t *settings);
+
 	bool PropertyClicked(obs_properties_t *props, obs_property_t *property);
 };
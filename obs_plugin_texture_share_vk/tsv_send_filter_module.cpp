@@ -0,0 +1,99 @@
+#include "tsv_obs_backend.hpp"
+#include "tsv_send_filter.hpp"
+
+#include <obs.h>
+// #include <obs/graphics/graphics.h>
+
+#include <mutex>
+
+
+extern "C"
+{
+	/* Required OBS module commands (required) */
+	OBS_DECLARE_MODULE();
+	OBS_MODULE_USE_DEFAULT_LOCALE(OBSPluginTextureShareFilter::PLUGIN_NAME.data(), "en-US");
+
+	// Define plugin info
+	const char *obs_get_name(void *type_data);
+	void *obs_create(obs_data_t *settings, obs_source_t *source);
+	void obs_destroy(void *data);
+	// uint32_t    obs_get_width(void *data);
+	// uint32_t    obs_get_height(void *data);
+	void obs_get_defaults(void *data, obs_data_t *defaults);
+	obs_properties_t *obs_get_properties(void *data);
+	void obs_update(void *data, obs_data_t *settings);
+	void obs_video_render(void *data, gs_effect_t *effect);
+
+	constexpr struct obs_source_info obs_plugin_shared_texture_filter_info = {
+		.id             = TsvSendFilter::PLUGIN_NAME.data(),
+		.type           = OBS_SOURCE_TYPE_FILTER,
+		.output_flags   = OBS_SOURCE_VIDEO,
+		.get_name       = obs_get_name,
+		.create         = obs_create,
+		.destroy        = obs_destroy,
+		.get_properties = obs_get_properties,
+		.update         = obs_update,
+		.video_render   = obs_video_render,
+		.get_defaults2  = obs_get_defaults,
+	};
+
+	// Load module
+	bool obs_module_load(void)
+	{
+		obs_register_source(&obs_plugin_shared_texture_filter_info);
+
+		return true;
+	}
+
+	const char *obs_get_name(void *type_data)
+	{
+		UNUSED_PARAMETER(type_data);
+		return TsvSendFilter::PLUGIN_NAME.data();
+	}
+
+	void *obs_create(obs_data_t *settings, obs_source_t *source)
+	{
+		// Enter graphics once per module to load OpenGL functions. Entering it waits for the render thread, so later
+		// instances skip it. The client connects in the background, creating an instance never waits for the server
+		static std::once_flag gl_loaded;
+		std::call_once(gl_loaded, []() {
+			obs_enter_graphics();
+			TextureShareGlClient::initialize_gl_external();
+			obs_leave_graphics();
+		});
+
+		void *data = bmalloc(sizeof(TsvSendFilter));
+		new(data) TsvSendFilter(settings, source, std::make_unique<TsvObsBackend>());
+
+		return data;
+	}
+
+	void obs_destroy(void *data)
+	{
+		if(data)
+		{
+			reinterpret_cast<TsvSendFilter *>(data)->~TsvSendFilter();
+			bfree(data);
+		}
+	}
+
+	void obs_get_defaults(void *data, obs_data_t *defaults)
+	{
+		return reinterpret_cast<TsvSendFilter *>(data)->GetDefaults(defaults);
+	}
+
+	obs_properties_t *obs_get_properties(void *data)
+	{
+		return reinterpret_cast<TsvSendFilter *>(data)->GetProperties();
+	}
+
+	void obs_update(void *data, obs_data_t *settings)
+	{
+		return reinterpret_cast<TsvSendFilter *>(data)->UpdateProperties(settings);
+	}
+
+	void obs_video_render(void *data, gs_effect_t *effect)
+	{
+		return reinterpret_cast<TsvSendFilter *>(data)->Render(effect);
+	}
+}
@@ -0,0 +1,74 @@
+#include "tsv_send_scheduler.hpp"
+
+#include "tsv_send_filter.hpp"
+
+#include <algorithm>
+
+
+TsvSendScheduler &TsvSendScheduler::GetInstance()
+{
+	static TsvSendScheduler instance;
+	return instance;
+}
+
+void TsvSendScheduler::Register(TsvSendFilter *filter, TsvBackend &backend)
+{
+	const auto lock = std::lock_guard(this->_access);
+	this->_entries.push_back(Entry{filter, &backend});
+	this->_published_entries.Publish(this->_entries);
+
+	if(!this->_callback_backend)
+	{
+		this->_callback_backend = &backend;
+		backend.AddMainRenderCallback(&TsvSendScheduler::SendPassCb, this);
+	}
+}
+
+void TsvSendScheduler::Unregister(TsvSendFilter *filter)
+{
+	const auto lock = std::lock_guard(this->_access);
+
+	const auto entry_it = std::find_if(this->_entries.begin(), this->_entries.end(),
+	                                   [filter](const Entry &entry) { return entry.filter == filter; });
+	if(entry_it == this->_entries.end())
+		return;
+
+	TsvBackend *const backend = entry_it->backend;
+	this->_entries.erase(entry_it);
+	this->_published_entries.Publish(this->_entries);
+
+	// The callback is registered with the backend of a filter that is about to be destroyed. Move it to another one
+	const bool backend_in_use = std::any_of(this->_entries.begin(), this->_entries.end(),
+	                                        [backend](const Entry &entry) { return entry.backend == backend; });
+	if(backend != this->_callback_backend || backend_in_use)
+		return;
+
+	this->_callback_backend->RemoveMainRenderCallback(&TsvSendScheduler::SendPassCb, this);
+	this->_callback_backend = nullptr;
+	if(!this->_entries.empty())
+	{
+		this->_callback_backend = this->_entries.front().backend;
+		this->_callback_backend->AddMainRenderCallback(&TsvSendScheduler::SendPassCb, this);
+	}
+}
+
+void TsvSendScheduler::SendPass(uint32_t cx, uint32_t cy)
+{
+	this->_published_entries.Adopt(this->_pass_entries);
+	if(!this->_pass_entries || this->_pass_entries->empty())
+		return;
+
+	// Note: A batch covers the sends of all backends of the module, so any filter's backend can open it
+	TsvBackend &backend = *this->_pass_entries->front().backend;
+	backend.BeginSendBatch();
+
+	for(const Entry &entry : *this->_pass_entries)
+		entry.filter->OffscreenRender(cx, cy);
+
+	backend.EndSendBatch();
+}
+
+void TsvSendScheduler::SendPassCb(void *param, uint32_t cx, uint32_t cy)
+{
+	return reinterpret_cast<TsvSendScheduler *>(param)->SendPass(cx, cy);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "tsv_backend.hpp"
+#include "tsv_snapshot.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TsvSendFilter;
+
+/*! \brief Module wide scheduler of the send filters' per frame work. Instead of one main render callback per filter, a
+ * single callback runs all registered filters back to back and submits their sends as one batch, so the callback and
+ * client setup costs are paid once per video frame instead of once per filter
+ */
+class TsvSendScheduler
+{
+	public:
+	static TsvSendScheduler &GetInstance();
+
+	/*! \brief Add filter to the send pass. backend must stay valid until the filter is unregistered. The first filter
+	 * registers the scheduler's main render callback with its backend
+	 */
+	void Register(TsvSendFilter *filter, TsvBackend &backend);
+
+	/*! \brief Remove filter from the send pass. A pass that is already running may still call the filter, hold the
+	 * graphics context afterwards to wait for it
+	 */
+	void Unregister(TsvSendFilter *filter);
+
+	/*! \brief Run all registered filters and send their frames in one batch. Called once per video frame by the main
+	 * render callback. Requires graphics context
+	 */
+	void SendPass(uint32_t cx, uint32_t cy);
+
+	private:
+	struct Entry
+	{
+		TsvSendFilter *filter = nullptr;
+		TsvBackend *backend   = nullptr;
+	};
+
+	std::mutex _access;
+	std::vector<Entry> _entries;
+
+	// Backend the main render callback is registered with. nullptr while no filter is registered
+	TsvBackend *_callback_backend = nullptr;
+
+	// Render thread copy of _entries
+	TsvSnapshot<std::vector<Entry>> _published_entries;
+	std::unique_ptr<const std::vector<Entry>> _pass_entries;
+
+	TsvSendScheduler() = default;
+
+	static void SendPassCb(void *param, uint32_t cx, uint32_t cy);
+};
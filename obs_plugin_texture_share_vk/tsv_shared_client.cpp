@@ -0,0 +1,145 @@
+#include "tsv_shared_client.hpp"
+
+#include <obs.h>
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace
+{
+	// Batch nesting depth of the calling thread. The client is locked while it is non-zero. Note: Each module has its
+	// own client and its own copy of this variable
+	thread_local uint32_t batch_depth = 0;
+} // namespace
+
+std::shared_ptr<TsvSharedClient> TsvSharedClient::Acquire()
+{
+	static std::mutex instance_access;
+	static std::weak_ptr<TsvSharedClient> instance;
+
+	const auto lock = std::lock_guard(instance_access);
+
+	auto client = instance.lock();
+	if(!client)
+	{
+		client   = std::shared_ptr<TsvSharedClient>(new TsvSharedClient());
+		instance = client;
+	}
+
+	return client;
+}
+
+TsvSharedClient::~TsvSharedClient()
+{
+	// Note: Waits for an attempt that is still launching the server. Only happens if the last instance is destroyed
+	// right after the first one was created. No other thread holds a reference, so no attempt can be started anymore
+	if(this->_connect_thread.joinable())
+		this->_connect_thread.join();
+}
+
+void TsvSharedClient::Connect()
+{
+	const auto lock = std::lock_guard(this->_connect_access);
+	this->StartConnect();
+}
+
+bool TsvSharedClient::IsConnected()
+{
+	const CONNECTION_STATE state = this->_state.load(std::memory_order_acquire);
+	if(state == CONNECTED)
+		return true;
+
+	// Retry failed attempts. Skipped if another thread is starting one right now
+	if(state == FAILED)
+	{
+		const auto lock = std::unique_lock(this->_connect_access, std::try_to_lock);
+		if(lock.owns_lock())
+			this->StartConnect();
+	}
+
+	return false;
+}
+
+TsvSharedClient::CONNECTION_STATE TsvSharedClient::GetState() const
+{
+	return this->_state.load(std::memory_order_acquire);
+}
+
+void TsvSharedClient::StartConnect()
+{
+	const CONNECTION_STATE state = this->_state.load(std::memory_order_acquire);
+	if(state == CONNECTING || state == CONNECTED)
+		return;
+
+	if(state == FAILED && std::chrono::steady_clock::now() < this->_retry_time)
+		return;
+
+	// A failed attempt's thread already finished, it set the state while holding _connect_access
+	if(this->_connect_thread.joinable())
+		this->_connect_thread.join();
+
+	this->_state.store(CONNECTING, std::memory_order_release);
+	this->_connect_thread = std::thread(&TsvSharedClient::RunConnect, this);
+}
+
+void TsvSharedClient::RunConnect()
+{
+	// Note: No other call is made into the client before it connected, so _access isn't held while the server launches
+	const bool connected = this->_client.init_with_server_launch();
+
+	const auto lock = std::lock_guard(this->_connect_access);
+	if(connected)
+	{
+		this->_retry_delay = MIN_RETRY_DELAY;
+		this->_state.store(CONNECTED, std::memory_order_release);
+		return;
+	}
+
+	blog(LOG_WARNING, "[texture-share-vk] Failed to connect to texture share server, retrying in %lld ms",
+	     static_cast<long long>(this->_retry_delay.count()));
+
+	this->_retry_time  = std::chrono::steady_clock::now() + this->_retry_delay;
+	this->_retry_delay = std::min(this->_retry_delay * 2, MAX_RETRY_DELAY);
+	this->_state.store(FAILED, std::memory_order_release);
+}
+
+std::unique_lock<std::mutex> TsvSharedClient::Lock()
+{
+	if(batch_depth > 0)
+		return std::unique_lock<std::mutex>();
+
+	return std::unique_lock<std::mutex>(this->_access);
+}
+
+void TsvSharedClient::BeginBatch()
+{
+	if(batch_depth++ > 0)
+		return;
+
+	this->_access.lock();
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &this->_batch_framebuffer);
+}
+
+void TsvSharedClient::EndBatch()
+{
+	if(batch_depth == 0 || --batch_depth > 0)
+		return;
+
+	this->_access.unlock();
+}
+
+GLint TsvSharedClient::GetDrawFramebuffer()
+{
+	if(batch_depth > 0)
+		return this->_batch_framebuffer;
+
+	GLint framebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+	return framebuffer;
+}
+
+TextureShareGlClient &TsvSharedClient::GetClient()
+{
+	return this->_client;
+}
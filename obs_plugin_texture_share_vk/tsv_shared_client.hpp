@@ -0,0 +1,98 @@
+#pragma once
+
+#include <texture_share_gl/texture_share_gl_client.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*! \brief Module wide texture share client. All TsvObsBackend instances of a module share one connection to the
+ * texture share server instead of performing their own handshake. Reference counted, the connection is closed once
+ * the last instance released it.
+ *
+ * The connection is made on a background thread, so creating plugin instances never waits for the server to launch.
+ * Failed attempts are retried with a growing delay
+ */
+class TsvSharedClient
+{
+	public:
+	enum CONNECTION_STATE
+	{
+		DISCONNECTED,
+		CONNECTING,
+		CONNECTED,
+		// Last attempt failed. Retried once the retry delay passed
+		FAILED,
+	};
+
+	// Delay before retrying a failed connection. Doubles with every failed attempt
+	static constexpr std::chrono::milliseconds MIN_RETRY_DELAY{1000};
+	static constexpr std::chrono::milliseconds MAX_RETRY_DELAY{30000};
+
+	/*! \brief Get the module's client. Creates it if no instance currently holds a reference
+	 */
+	static std::shared_ptr<TsvSharedClient> Acquire();
+
+	~TsvSharedClient();
+
+	TsvSharedClient(const TsvSharedClient &)            = delete;
+	TsvSharedClient &operator=(const TsvSharedClient &) = delete;
+
+	/*! \brief Start connecting to texture share server on a background thread, launching it if none is running.
+	 * Returns immediately. Does nothing while connecting, once connected, or before the retry delay of a failed attempt
+	 * passed
+	 */
+	void Connect();
+
+	/*! \brief Whether the client is connected. Starts the next attempt once the retry delay of a failed one passed.
+	 * Never blocks, can be called every frame. No other call may be made into the client before this returned true
+	 */
+	bool IsConnected();
+
+	CONNECTION_STATE GetState() const;
+
+	/*! \brief Lock the client for a single call into GetClient(). Returns an empty lock while the calling thread runs a
+	 * batch, which already holds the client
+	 */
+	std::unique_lock<std::mutex> Lock();
+
+	/*! \brief Start a batch of calls from the calling thread. The client is locked and the draw framebuffer binding is
+	 * queried once for the whole batch. Requires graphics context. Must be followed by EndBatch() on the same thread
+	 */
+	void BeginBatch();
+	void EndBatch();
+
+	/*! \brief Draw framebuffer binding passed to send_image and recv_image, which restore it after copying. Only
+	 * queried once per batch. Requires graphics context
+	 */
+	GLint GetDrawFramebuffer();
+
+	TextureShareGlClient &GetClient();
+
+	private:
+	std::mutex _access;
+	TextureShareGlClient _client;
+
+	std::atomic<CONNECTION_STATE> _state = DISCONNECTED;
+
+	// Guards the connecting thread and the retry timing
+	std::mutex _connect_access;
+	std::thread _connect_thread;
+	std::chrono::steady_clock::time_point _retry_time;
+	std::chrono::milliseconds _retry_delay = MIN_RETRY_DELAY;
+
+	// Framebuffer bound when the batch started. Texrenders restore it, so it stays valid for the whole batch
+	GLint _batch_framebuffer = 0;
+
+	TsvSharedClient() = default;
+
+	/*! \brief Start a connection attempt. Requires _connect_access
+	 */
+	void StartConnect();
+
+	/*! \brief Connecting thread
+	 */
+	void RunConnect();
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+/*! \brief Hands immutable snapshots of T from any number of writer threads to a single reader thread without locking.
+ * Writers publish a copy, the reader adopts the newest one whenever it is ready to switch. Snapshots the reader did not
+ * adopt yet are replaced, so the reader never sees intermediate states. As only the reader holds the current snapshot,
+ * it can be released without waiting for other readers
+ */
+template<class T>
+class TsvSnapshot
+{
+	public:
+	TsvSnapshot() = default;
+	~TsvSnapshot()
+	{
+		delete this->_pending.load(std::memory_order_acquire);
+	}
+
+	TsvSnapshot(const TsvSnapshot &)            = delete;
+	TsvSnapshot &operator=(const TsvSnapshot &) = delete;
+
+	/*! \brief Publish a copy of value. Allocates, so not meant for the render thread
+	 */
+	void Publish(const T &value)
+	{
+		delete this->_pending.exchange(new T(value), std::memory_order_acq_rel);
+	}
+
+	/*! \brief Replace current with the newest published snapshot. Returns false if nothing was published since the
+	 * last call. Must only be called from the reader thread
+	 */
+	bool Adopt(std::unique_ptr<const T> &current)
+	{
+		// Plain load first, the exchange is only needed once something was published
+		if(!this->_pending.load(std::memory_order_relaxed))
+			return false;
+
+		T *const pending = this->_pending.exchange(nullptr, std::memory_order_acq_rel);
+		if(!pending)
+			return false;
+
+		current.reset(pending);
+		return true;
+	}
+
+	private:
+	std::atomic<T *> _pending = nullptr;
+};
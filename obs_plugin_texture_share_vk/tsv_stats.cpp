@@ -0,0 +1,210 @@
+#include "tsv_stats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cstdio>
+
+
+uint64_t TsvStats::TimerSnapshot::GetPercentileUs(double percentile) const
+{
+	if(this->count == 0)
+		return 0;
+
+	const uint64_t rank = static_cast<uint64_t>(percentile * static_cast<double>(this->count));
+
+	uint64_t cumulative = 0;
+	for(size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		cumulative += this->buckets[i];
+		if(cumulative > rank)
+			return i + 1 < BUCKET_COUNT ? 1ull << i : this->max_ns / 1000;
+	}
+
+	return this->max_ns / 1000;
+}
+
+void TsvStats::RecordDuration(TIMER timer, std::chrono::nanoseconds duration)
+{
+	const uint64_t duration_ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+	const size_t bucket        = std::min<size_t>(std::bit_width(duration_ns / 1000), BUCKET_COUNT - 1);
+
+	Timer &data = this->_timers[timer];
+	data.count.fetch_add(1, std::memory_order_relaxed);
+	data.total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+	data.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max_ns = data.max_ns.load(std::memory_order_relaxed);
+	while(duration_ns > max_ns && !data.max_ns.compare_exchange_weak(max_ns, duration_ns, std::memory_order_relaxed))
+	{}
+}
+
+TsvStats::TimerSnapshot TsvStats::GetTimer(TIMER timer) const
+{
+	const Timer &data = this->_timers[timer];
+
+	TimerSnapshot snapshot;
+	snapshot.count    = data.count.load(std::memory_order_relaxed);
+	snapshot.total_ns = data.total_ns.load(std::memory_order_relaxed);
+	snapshot.max_ns   = data.max_ns.load(std::memory_order_relaxed);
+	for(size_t i = 0; i < BUCKET_COUNT; ++i)
+		snapshot.buckets[i] = data.buckets[i].load(std::memory_order_relaxed);
+
+	return snapshot;
+}
+
+std::string TsvStats::ToJson(const TsvMutex &access) const
+{
+	char buffer[128];
+	std::string json = "{";
+
+	for(size_t i = 0; i < COUNTER_COUNT; ++i)
+	{
+		const COUNTER counter = static_cast<COUNTER>(i);
+		std::snprintf(buffer, sizeof(buffer), "\"%s\":%" PRIu64 ",", GetCounterName(counter), this->GetCount(counter));
+		json += buffer;
+	}
+
+	std::snprintf(buffer, sizeof(buffer), "\"lock_count\":%" PRIu64 ",\"lock_hold_ns\":%" PRIu64
+	              ",\"lock_contentions\":%" PRIu64 ",",
+	              access.LockCount(), access.HoldTimeNs(), access.ContentionCount());
+	json += buffer;
+
+	json += "\"timers\":{";
+	for(size_t i = 0; i < TIMER_COUNT; ++i)
+	{
+		const TIMER timer            = static_cast<TIMER>(i);
+		const TimerSnapshot snapshot = this->GetTimer(timer);
+
+		std::snprintf(buffer, sizeof(buffer),
+		              "%s\"%s\":{\"count\":%" PRIu64 ",\"total_ns\":%" PRIu64 ",\"max_ns\":%" PRIu64 ",\"histogram_us\":[",
+		              i > 0 ? "," : "", GetTimerName(timer), snapshot.count, snapshot.total_ns, snapshot.max_ns);
+		json += buffer;
+
+		for(size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%s%" PRIu64, bucket > 0 ? "," : "", snapshot.buckets[bucket]);
+			json += buffer;
+		}
+
+		json += "]}";
+	}
+	json += "}}";
+
+	return json;
+}
+
+void TsvStats::AddProperties(obs_properties_t *properties, const TsvMutex &access) const
+{
+	obs_properties_t *const group = obs_properties_create();
+
+	// Info texts show their description, so every line gets its own property
+	for(size_t i = 0; i < COUNTER_COUNT; ++i)
+	{
+		const COUNTER counter  = static_cast<COUNTER>(i);
+		const std::string name = std::string(PROPERTY_STATS) + "_" + GetCounterName(counter);
+		obs_properties_add_text(group, name.c_str(), this->FormatCounter(counter).c_str(), OBS_TEXT_INFO);
+	}
+
+	for(size_t i = 0; i < TIMER_COUNT; ++i)
+	{
+		const TIMER timer      = static_cast<TIMER>(i);
+		const std::string name = std::string(PROPERTY_STATS) + "_" + GetTimerName(timer);
+		obs_properties_add_text(group, name.c_str(), this->FormatTimer(timer).c_str(), OBS_TEXT_INFO);
+	}
+
+	const std::string lock_name = std::string(PROPERTY_STATS) + "_lock";
+	obs_properties_add_text(group, lock_name.c_str(), FormatLock(access).c_str(), OBS_TEXT_INFO);
+
+	obs_properties_add_button(group, PROPERTY_STATS_REFRESH.data(), obs_module_text(PROPERTY_STATS_REFRESH.data()),
+	                          &TsvStats::RefreshClickedCb);
+
+	obs_properties_add_group(properties, PROPERTY_STATS.data(), obs_module_text(PROPERTY_STATS.data()),
+	                         OBS_GROUP_NORMAL, group);
+}
+
+std::string TsvStats::FormatCounter(COUNTER counter) const
+{
+	char buffer[128];
+	std::snprintf(buffer, sizeof(buffer), "%s: %" PRIu64, GetCounterName(counter), this->GetCount(counter));
+	return buffer;
+}
+
+std::string TsvStats::FormatTimer(TIMER timer) const
+{
+	const TimerSnapshot snapshot = this->GetTimer(timer);
+	const double average_us      = snapshot.count > 0 ? snapshot.total_ns / 1000.0 / snapshot.count : 0.0;
+
+	char buffer[192];
+	std::snprintf(buffer, sizeof(buffer),
+	              "%s: %" PRIu64 " samples, avg %.1f us, p50 < %" PRIu64 " us, p99 < %" PRIu64 " us, max %.1f us",
+	              GetTimerName(timer), snapshot.count, average_us, snapshot.GetPercentileUs(0.5),
+	              snapshot.GetPercentileUs(0.99), snapshot.max_ns / 1000.0);
+	return buffer;
+}
+
+std::string TsvStats::FormatLock(const TsvMutex &access)
+{
+	char buffer[128];
+	std::snprintf(buffer, sizeof(buffer), "lock: %" PRIu64 " locks, %" PRIu64 " contended, %.1f ms held",
+	              access.LockCount(), access.ContentionCount(), access.HoldTimeNs() / 1e6);
+	return buffer;
+}
+
+const char *TsvStats::GetCounterName(COUNTER counter)
+{
+	switch(counter)
+	{
+		case FRAMES_SENT:
+			return "frames_sent";
+		case FRAMES_RECEIVED:
+			return "frames_received";
+		case FRAMES_SKIPPED:
+			return "frames_skipped";
+		case FRAMES_UNCHANGED:
+			return "frames_unchanged";
+		case FRAMES_PARTIAL:
+			return "frames_partial";
+		case FRAMES_TORN:
+			return "frames_torn";
+		case FRAMES_DROPPED:
+			return "frames_dropped";
+		case FRAMES_PREFETCHED:
+			return "frames_prefetched";
+		case IMAGE_LOOKUPS:
+			return "image_lookups";
+		case RESIZES:
+			return "resizes";
+		default:
+			return "unknown";
+	}
+}
+
+const char *TsvStats::GetTimerName(TIMER timer)
+{
+	switch(timer)
+	{
+		case RENDER:
+			return "render";
+		case SEND_IMAGE:
+			return "send_image";
+		case RECV_IMAGE:
+			return "recv_image";
+		case WRITE_CPU_FRAME:
+			return "write_cpu_frame";
+		case READ_CPU_FRAME:
+			return "read_cpu_frame";
+		case LATENCY:
+			return "latency";
+		case JITTER:
+			return "jitter";
+		default:
+			return "unknown";
+	}
+}
+
+bool TsvStats::RefreshClickedCb(obs_properties_t * /*props*/, obs_property_t * /*property*/, void * /*data*/)
+{
+	// Rebuild the properties, which formats the current values
+	return true;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "tsv_mutex.hpp"
+
+#include <obs-module.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*! \brief Performance counters and duration histograms of a plugin instance. Recording a sample is a few relaxed
+ * atomic operations, it never allocates or locks, so it can be done on the render thread. Values are read and
+ * formatted from other threads, e.g. for the properties dialog or the get_stats proc handler
+ */
+class TsvStats
+{
+	public:
+	static constexpr std::string_view PROPERTY_STATS         = "stats";
+	static constexpr std::string_view PROPERTY_STATS_REFRESH = "stats_refresh";
+
+	// Declaration of the proc handler returning ToJson()
+	static constexpr std::string_view PROC_GET_STATS = "void get_stats(out string stats)";
+
+	enum COUNTER
+	{
+		FRAMES_SENT,
+		FRAMES_RECEIVED,
+		// Frames that were not captured or copied, e.g. without consumer, due to the send rate or because the sender
+		// did not publish a new frame
+		FRAMES_SKIPPED,
+		// Frames that were identical to the previously sent one and therefore not sent
+		FRAMES_UNCHANGED,
+		// Frames of which only the changed region was sent or copied
+		FRAMES_PARTIAL,
+		// CPU frames the sender overwrote while they were copied
+		FRAMES_TORN,
+		// Frames the sender published that were never drawn, because a newer frame replaced them first
+		FRAMES_DROPPED,
+		// Frames copied by the main render callback, ahead of drawing them
+		FRAMES_PREFETCHED,
+		// Image lookups on the texture share server
+		IMAGE_LOOKUPS,
+		// Recreated render targets or textures
+		RESIZES,
+		COUNTER_COUNT,
+	};
+
+	enum TIMER
+	{
+		// Capturing or offscreen rendering a frame
+		RENDER,
+		SEND_IMAGE,
+		RECV_IMAGE,
+		// Copying a frame into or out of the shared memory frame ring
+		WRITE_CPU_FRAME,
+		READ_CPU_FRAME,
+		// Time from the video frame a frame was captured in by the sender to the video frame it is first drawn in
+		LATENCY,
+		// Difference between the latencies of consecutively drawn frames
+		JITTER,
+		TIMER_COUNT,
+	};
+
+	// Histogram bucket i counts durations below 2^i microseconds. The last bucket counts all longer durations. Covers
+	// latencies of several video frames
+	static constexpr size_t BUCKET_COUNT = 20;
+
+	/*! \brief Consistent enough copy of a timer for reporting. Values may be off by the samples recorded while copying
+	 */
+	struct TimerSnapshot
+	{
+		uint64_t count    = 0;
+		uint64_t total_ns = 0;
+		uint64_t max_ns   = 0;
+		std::array<uint64_t, BUCKET_COUNT> buckets{};
+
+		/*! \brief Upper bound (in microseconds) of the bucket containing the given percentile (0-1)
+		 */
+		uint64_t GetPercentileUs(double percentile) const;
+	};
+
+	/*! \brief Measures the duration from construction to destruction
+	 */
+	class ScopedTimer
+	{
+		public:
+		ScopedTimer(TsvStats &stats, TIMER timer)
+			: _stats(stats),
+			  _timer(timer),
+			  _start(std::chrono::steady_clock::now())
+		{}
+
+		~ScopedTimer()
+		{
+			this->_stats.RecordDuration(this->_timer, std::chrono::steady_clock::now() - this->_start);
+		}
+
+		ScopedTimer(const ScopedTimer &)            = delete;
+		ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+		private:
+		TsvStats &_stats;
+		TIMER _timer;
+		std::chrono::steady_clock::time_point _start;
+	};
+
+	void Increment(COUNTER counter, uint64_t value = 1)
+	{
+		this->_counters[counter].fetch_add(value, std::memory_order_relaxed);
+	}
+
+	void RecordDuration(TIMER timer, std::chrono::nanoseconds duration);
+
+	uint64_t GetCount(COUNTER counter) const
+	{
+		return this->_counters[counter].load(std::memory_order_relaxed);
+	}
+
+	TimerSnapshot GetTimer(TIMER timer) const;
+
+	/*! \brief Format all counters, timers and the lock statistics of access as JSON object
+	 */
+	std::string ToJson(const TsvMutex &access) const;
+
+	/*! \brief Add a read-only group showing all values, and a button to refresh it
+	 */
+	void AddProperties(obs_properties_t *properties, const TsvMutex &access) const;
+
+	/*! \brief Format a counter or timer as a single line for display
+	 */
+	std::string FormatCounter(COUNTER counter) const;
+	std::string FormatTimer(TIMER timer) const;
+	static std::string FormatLock(const TsvMutex &access);
+
+	static const char *GetCounterName(COUNTER counter);
+	static const char *GetTimerName(TIMER timer);
+
+	private:
+	struct Timer
+	{
+		std::atomic<uint64_t> count    = 0;
+		std::atomic<uint64_t> total_ns = 0;
+		std::atomic<uint64_t> max_ns   = 0;
+		std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+	};
+
+	std::array<std::atomic<uint64_t>, COUNTER_COUNT> _counters{};
+	std::array<Timer, TIMER_COUNT> _timers;
+
+	static bool RefreshClickedCb(obs_properties_t *props, obs_property_t *property, void *data);
+};
@@ -0,0 +1,118 @@
+#include "tsv_texture_pool.hpp"
+
+
+TsvTexturePool::TsvTexturePool(destroy_callback_t destroy, uint64_t memory_limit)
+	: _destroy(std::move(destroy)),
+	  _memory_limit(memory_limit)
+{}
+
+TsvTexturePool::~TsvTexturePool()
+{
+	this->Clear();
+}
+
+void *TsvTexturePool::Take(const Key &key)
+{
+	const auto lock = std::lock_guard(this->_access);
+	for(auto entry_it = this->_entries.begin(); entry_it != this->_entries.end(); ++entry_it)
+	{
+		if(entry_it->key != key)
+			continue;
+
+		void *const resource = entry_it->resource;
+		this->_cached_bytes -= GetResourceBytes(entry_it->key);
+		this->_entries.erase(entry_it);
+
+		return resource;
+	}
+
+	return nullptr;
+}
+
+void TsvTexturePool::Put(const Key &key, void *resource)
+{
+	if(!resource)
+		return;
+
+	std::list<Entry> evicted;
+	{
+		const auto lock = std::lock_guard(this->_access);
+		this->_entries.push_front(Entry{key, resource});
+		this->_cached_bytes += GetResourceBytes(key);
+
+		evicted = this->EvictLocked(this->_memory_limit);
+	}
+
+	this->Destroy(evicted);
+}
+
+void TsvTexturePool::Clear()
+{
+	std::list<Entry> evicted;
+	{
+		const auto lock = std::lock_guard(this->_access);
+		evicted         = this->EvictLocked(0);
+	}
+
+	this->Destroy(evicted);
+}
+
+uint64_t TsvTexturePool::GetCachedBytes() const
+{
+	const auto lock = std::lock_guard(this->_access);
+	return this->_cached_bytes;
+}
+
+uint64_t TsvTexturePool::GetResourceBytes(const Key &key)
+{
+	uint64_t bytes_per_pixel;
+	switch(key.format)
+	{
+		case GS_A8:
+		case GS_R8:
+			bytes_per_pixel = 1;
+			break;
+		case GS_R16:
+		case GS_R16F:
+		case GS_R8G8:
+			bytes_per_pixel = 2;
+			break;
+		case GS_RGBA16:
+		case GS_RGBA16F:
+		case GS_RG32F:
+			bytes_per_pixel = 8;
+			break;
+		case GS_RGBA32F:
+			bytes_per_pixel = 16;
+			break;
+		default:
+			bytes_per_pixel = 4;
+			break;
+	}
+
+	return static_cast<uint64_t>(key.width) * key.height * bytes_per_pixel;
+}
+
+std::list<TsvTexturePool::Entry> TsvTexturePool::EvictLocked(uint64_t memory_limit)
+{
+	std::list<Entry> evicted;
+	while(!this->_entries.empty() && this->_cached_bytes > memory_limit)
+	{
+		this->_cached_bytes -= GetResourceBytes(this->_entries.back().key);
+		evicted.splice(evicted.end(), this->_entries, std::prev(this->_entries.end()));
+	}
+
+	// Zero sized resources (e.g. never rendered texrenders) don't count towards the limit
+	if(memory_limit == 0)
+		evicted.splice(evicted.end(), this->_entries);
+
+	return evicted;
+}
+
+void TsvTexturePool::Destroy(std::list<Entry> &entries)
+{
+	for(const Entry &entry : entries)
+		this->_destroy(entry.key.type, entry.resource);
+
+	entries.clear();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+
+/*! \brief Cache of unused textures and texrenders, keyed by (type, width, height, format). Destroyed resources are
+ * put into the pool instead of being released, and handed out again when a resource with the same key is created.
+ * Avoids GPU allocations when a sender switches between a few resolutions or an image is renamed.
+ *
+ * The pool only stores resources, allocating them is up to the caller. Cached resources are evicted in least recently
+ * used order once they exceed the memory limit
+ */
+class TsvTexturePool
+{
+	public:
+	enum RESOURCE_TYPE
+	{
+		TEXTURE,
+		TEXRENDER
+	};
+
+	struct Key
+	{
+		RESOURCE_TYPE type     = TEXTURE;
+		uint32_t width         = 0;
+		uint32_t height        = 0;
+		gs_color_format format = GS_UNKNOWN;
+
+		bool operator==(const Key &other) const = default;
+	};
+
+	using destroy_callback_t = std::function<void(RESOURCE_TYPE type, void *resource)>;
+
+	// Default upper bound for the memory of all cached resources
+	static constexpr uint64_t DEFAULT_MEMORY_LIMIT = 256ull * 1024 * 1024;
+
+	/*! \brief Create pool. destroy is called for evicted resources, without holding the pool's lock
+	 */
+	explicit TsvTexturePool(destroy_callback_t destroy, uint64_t memory_limit = DEFAULT_MEMORY_LIMIT);
+	~TsvTexturePool();
+
+	TsvTexturePool(const TsvTexturePool &)            = delete;
+	TsvTexturePool &operator=(const TsvTexturePool &) = delete;
+
+	/*! \brief Remove a cached resource matching key from the pool. Returns nullptr if none is cached
+	 */
+	void *Take(const Key &key);
+
+	/*! \brief Cache an unused resource. Evicts the least recently cached resources if the memory limit is exceeded
+	 */
+	void Put(const Key &key, void *resource);
+
+	/*! \brief Destroy all cached resources
+	 */
+	void Clear();
+
+	/*! \brief Memory (in bytes) of all cached resources
+	 */
+	uint64_t GetCachedBytes() const;
+
+	/*! \brief Estimated memory (in bytes) of a resource
+	 */
+	static uint64_t GetResourceBytes(const Key &key);
+
+	private:
+	struct Entry
+	{
+		Key key;
+		void *resource = nullptr;
+	};
+
+	destroy_callback_t _destroy;
+
+	mutable std::mutex _access;
+
+	// Most recently cached entries first
+	std::list<Entry> _entries;
+
+	uint64_t _cached_bytes = 0;
+
+	// Set once by the constructor, e.g. from TSV_TEXTURE_POOL_LIMIT_MB
+	const uint64_t _memory_limit = DEFAULT_MEMORY_LIMIT;
+
+	/*! \brief Remove entries exceeding the memory limit. Must hold _access, evicted entries are destroyed by the caller
+	 */
+	std::list<Entry> EvictLocked(uint64_t memory_limit);
+
+	void Destroy(std::list<Entry> &entries);
+};
@@ -0,0 +1,197 @@
+#include "tsv_trace.hpp"
+
+#include <obs.h>
+#include <util/platform.h>
+
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+
+TsvTrace &TsvTrace::GetInstance()
+{
+	static TsvTrace instance;
+	return instance;
+}
+
+void TsvTrace::Reserve()
+{
+	const auto lock = std::lock_guard(this->_access);
+	if(this->_storage)
+		return;
+
+	this->_storage = std::make_unique<Event[]>(EVENT_COUNT);
+	this->_events.store(this->_storage.get(), std::memory_order_release);
+}
+
+void TsvTrace::Record(const char *category, const char *name, const std::string &image, uint64_t start_ns,
+                      uint64_t end_ns)
+{
+	Event *const events = this->_events.load(std::memory_order_acquire);
+	if(!events)
+		return;
+
+	const uint64_t index = this->_next_index.fetch_add(1, std::memory_order_relaxed);
+	Event &event         = events[index % EVENT_COUNT];
+
+	// Note: Readers that see the cleared sequence after reading the slot discard what they read
+	event.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	event.start_ns  = start_ns;
+	event.end_ns    = end_ns;
+	event.category  = category;
+	event.name      = name;
+	event.thread_id = GetThreadId();
+
+	// Don't cut a UTF-8 sequence in half, the dump must stay valid JSON
+	size_t image_size = std::min(image.size(), IMAGE_NAME_SIZE - 1);
+	while(image_size > 0 && image_size < image.size() &&
+	      (static_cast<unsigned char>(image[image_size]) & 0xC0) == 0x80)
+		--image_size;
+
+	std::memcpy(event.image, image.data(), image_size);
+	event.image[image_size] = '\0';
+
+	event.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::string TsvTrace::ToJson() const
+{
+	const long pid   = static_cast<long>(getpid());
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	const Event *const events  = this->_events.load(std::memory_order_acquire);
+	const uint64_t end_index   = this->_next_index.load(std::memory_order_acquire);
+	const uint64_t begin_index = end_index > EVENT_COUNT ? end_index - EVENT_COUNT : 0;
+
+	bool first = true;
+	for(uint64_t index = begin_index; events && index < end_index; ++index)
+	{
+		const Event &event = events[index % EVENT_COUNT];
+		if(event.sequence.load(std::memory_order_acquire) != index + 1)
+			continue;
+
+		Event copy;
+		copy.start_ns  = event.start_ns;
+		copy.end_ns    = event.end_ns;
+		copy.category  = event.category;
+		copy.name      = event.name;
+		copy.thread_id = event.thread_id;
+		std::memcpy(copy.image, event.image, IMAGE_NAME_SIZE);
+		copy.image[IMAGE_NAME_SIZE - 1] = '\0';
+
+		// Overwritten while copying
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(event.sequence.load(std::memory_order_relaxed) != index + 1)
+			continue;
+
+		// Complete events, timestamps in microseconds
+		char buffer[256];
+		std::snprintf(buffer, sizeof(buffer),
+		              "%s{\"ph\":\"X\",\"pid\":%ld,\"tid\":%" PRIu32
+		              ",\"ts\":%.3f,\"dur\":%.3f,\"cat\":\"%s\",\"name\":\"%s\",\"args\":{\"image\":\"",
+		              first ? "" : ",", pid, copy.thread_id, copy.start_ns / 1000.0,
+		              (copy.end_ns - copy.start_ns) / 1000.0, copy.category, copy.name);
+		json += buffer;
+		AppendEscaped(json, copy.image);
+		json += "\"}}";
+
+		first = false;
+	}
+
+	json += "]}";
+	return json;
+}
+
+std::string TsvTrace::Dump() const
+{
+	char file_name[64];
+	const std::time_t now = std::time(nullptr);
+	std::tm local_time;
+	localtime_r(&now, &local_time);
+	std::strftime(file_name, sizeof(file_name), "traces/tsv_trace_%Y-%m-%d_%H-%M-%S.json", &local_time);
+
+	char *const directory = obs_module_config_path("traces");
+	char *const path      = obs_module_config_path(file_name);
+	std::string result;
+	if(directory && path && os_mkdirs(directory) != MKDIR_ERROR)
+	{
+		if(std::FILE *const file = std::fopen(path, "w"))
+		{
+			const std::string json = this->ToJson();
+			if(std::fwrite(json.data(), 1, json.size(), file) == json.size())
+				result = path;
+
+			std::fclose(file);
+		}
+	}
+
+	bfree(directory);
+	bfree(path);
+	return result;
+}
+
+void TsvTrace::AddProperties(obs_properties_t *properties)
+{
+	obs_properties_add_bool(properties, PROPERTY_TRACE.data(), obs_module_text(PROPERTY_TRACE.data()));
+	obs_properties_add_button(properties, PROPERTY_TRACE_DUMP.data(), obs_module_text(PROPERTY_TRACE_DUMP.data()),
+	                          &TsvTrace::DumpClickedCb);
+}
+
+uint64_t TsvTrace::NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void TsvTrace::GetTraceCb(void * /*data*/, calldata_t *cd)
+{
+	calldata_set_string(cd, "trace", GetInstance().ToJson().c_str());
+}
+
+uint32_t TsvTrace::GetThreadId()
+{
+	// Kernel thread id, as shown by OBS' profiler and system tools
+	thread_local const uint32_t thread_id = static_cast<uint32_t>(syscall(SYS_gettid));
+	return thread_id;
+}
+
+void TsvTrace::AppendEscaped(std::string &json, const char *text)
+{
+	for(; *text; ++text)
+	{
+		const unsigned char c = static_cast<unsigned char>(*text);
+		if(c == '"' || c == '\\')
+		{
+			json += '\\';
+			json += static_cast<char>(c);
+		}
+		else if(c < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			json += escaped;
+		}
+		else
+			json += static_cast<char>(c);
+	}
+}
+
+bool TsvTrace::DumpClickedCb(obs_properties_t * /*props*/, obs_property_t * /*property*/, void * /*data*/)
+{
+	const std::string path = GetInstance().Dump();
+	if(path.empty())
+		blog(LOG_WARNING, "[texture-share-vk] Failed to write trace");
+	else
+		blog(LOG_INFO, "[texture-share-vk] Wrote trace to %s", path.c_str());
+
+	return false;
+}
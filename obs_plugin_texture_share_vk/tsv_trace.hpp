@@ -0,0 +1,125 @@
+#pragma once
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/*! \brief Module wide ring of timestamped events, dumped in the Chrome trace event format that Perfetto and
+ * chrome://tracing open. Opt-in per plugin instance. The ring is only allocated once an instance enables tracing.
+ * Recording an event is a few atomic operations and a short copy, it never allocates or locks, so it can be done on the
+ * render thread. Once the ring is full, the oldest events are overwritten
+ */
+class TsvTrace
+{
+	public:
+	static constexpr std::string_view PROPERTY_TRACE      = "trace";
+	static constexpr std::string_view PROPERTY_TRACE_DUMP = "trace_dump";
+
+	// Declaration of the proc handler returning ToJson()
+	static constexpr std::string_view PROC_GET_TRACE = "void get_trace(out string trace)";
+
+	// About a minute of events of a few instances at 60 fps
+	static constexpr size_t EVENT_COUNT = 32768;
+
+	// Longer image names are truncated
+	static constexpr size_t IMAGE_NAME_SIZE = 48;
+
+	/*! \brief Records an event covering the time from construction to destruction, if enabled. image is read on
+	 * destruction, so that renames within the scope are recorded as well
+	 */
+	class ScopedEvent
+	{
+		public:
+		ScopedEvent(bool enabled, const char *category, const char *name, const std::string &image)
+			: _category(enabled ? category : nullptr),
+			  _name(name),
+			  _image(image),
+			  _start_ns(enabled ? NowNs() : 0)
+		{}
+
+		~ScopedEvent()
+		{
+			if(this->_category)
+				TsvTrace::GetInstance().Record(this->_category, this->_name, this->_image, this->_start_ns, NowNs());
+		}
+
+		ScopedEvent(const ScopedEvent &)            = delete;
+		ScopedEvent &operator=(const ScopedEvent &) = delete;
+
+		private:
+		const char *_category;
+		const char *_name;
+		const std::string &_image;
+		uint64_t _start_ns;
+	};
+
+	static TsvTrace &GetInstance();
+
+	TsvTrace(const TsvTrace &)            = delete;
+	TsvTrace &operator=(const TsvTrace &) = delete;
+
+	/*! \brief Allocate the ring. Called when an instance enables tracing, not meant for the render thread
+	 */
+	void Reserve();
+
+	/*! \brief Record an event that started at start_ns and ended at end_ns (CLOCK_MONOTONIC). category and name must be
+	 * string literals. Dropped if the ring was not allocated
+	 */
+	void Record(const char *category, const char *name, const std::string &image, uint64_t start_ns, uint64_t end_ns);
+
+	/*! \brief Format all recorded events as Chrome trace JSON
+	 */
+	std::string ToJson() const;
+
+	/*! \brief Write ToJson() to a new file in the module's config directory. Returns the path, or an empty string on
+	 * failure
+	 */
+	std::string Dump() const;
+
+	/*! \brief Add a checkbox enabling tracing for the instance, and a button dumping the module's trace
+	 */
+	static void AddProperties(obs_properties_t *properties);
+
+	/*! \brief Current CLOCK_MONOTONIC time, the clock OBS' profiler uses as well
+	 */
+	static uint64_t NowNs();
+
+	static void GetTraceCb(void *data, calldata_t *cd);
+
+	private:
+	struct Event
+	{
+		// Index + 1 of the event in the slot. 0 while it is written
+		std::atomic<uint64_t> sequence = 0;
+
+		uint64_t start_ns    = 0;
+		uint64_t end_ns      = 0;
+		const char *category = nullptr;
+		const char *name     = nullptr;
+		uint32_t thread_id   = 0;
+		char image[IMAGE_NAME_SIZE]{};
+	};
+
+	// Serializes Reserve()
+	std::mutex _access;
+	std::unique_ptr<Event[]> _storage;
+
+	// Published once _storage is allocated
+	std::atomic<Event *> _events = nullptr;
+
+	// Index of the next recorded event
+	std::atomic<uint64_t> _next_index = 0;
+
+	TsvTrace() = default;
+
+	static uint32_t GetThreadId();
+	static void AppendEscaped(std::string &json, const char *text);
+
+	static bool DumpClickedCb(obs_properties_t *props, obs_property_t *property, void *data);
+};